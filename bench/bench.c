@@ -0,0 +1,294 @@
+#include <plotinc/plotinc.h>
+#include <time.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+/* benchmark of rendering hot paths of plotinc.
+ * Results are printed in CSV with a header line to the standard output:
+ *   case,param,repeat,ns_per_repeat,ns_per_point,frames_per_s,peak_rss_kb
+ * where param is the number of points, samples or frames of the case, and
+ * fields not applicable to the case are empty. Each line is measured in a
+ * child process, so that the peak RSS is of the case alone. */
+
+#define BENCH_MIN_TIME   0.5 /* seconds spent on each case at least */
+#define BENCH_MAX_REPEAT 1000
+
+static int bench_width  = PLOTINC_CANVAS_DEFAULT_WIDTH;
+static int bench_height = PLOTINC_CANVAS_DEFAULT_HEIGHT;
+static bool bench_svg = false;
+static double bench_max_points = 1e7;
+
+static double bench_now(void)
+{
+  struct timespec ts;
+
+  clock_gettime( CLOCK_MONOTONIC, &ts );
+  return ts.tv_sec + ts.tv_nsec * 1.0e-9;
+}
+
+static long bench_peak_rss(void)
+{
+  struct rusage usage;
+
+  getrusage( RUSAGE_SELF, &usage );
+  return usage.ru_maxrss; /* in kilobytes on Linux */
+}
+
+/* fork a child process to run a case in, where true is returned and
+ * bench_exit() has to be called at last. The parent waits for the child
+ * and false is returned. */
+static bool bench_fork(void)
+{
+  pid_t pid;
+  int status;
+
+  fflush( stdout );
+  if( ( pid = fork() ) < 0 ){
+    perror( "fork" );
+    exit( EXIT_FAILURE );
+  }
+  if( pid == 0 ) return true;
+  if( waitpid( pid, &status, 0 ) < 0 || !WIFEXITED( status ) || WEXITSTATUS( status ) != EXIT_SUCCESS ){
+    fprintf( stderr, "a benchmark case failed.\n" );
+    exit( EXIT_FAILURE );
+  }
+  return false;
+}
+
+static void bench_exit(void)
+{
+  fflush( stdout );
+  _exit( EXIT_SUCCESS );
+}
+
+static bool bench_open(plotincCanvas *canvas)
+{
+  /* a vector output is written to nowhere */
+  return bench_svg ?
+    plotincCanvasOpenSVG( canvas, bench_width, bench_height, "/dev/null" ) :
+    plotincCanvasOpenImage( canvas, bench_width, bench_height );
+}
+
+static void bench_close(plotincCanvas *canvas)
+{
+  if( bench_svg )
+    plotincCanvasCloseSVG( canvas );
+  else
+    plotincCanvasCloseImage( canvas );
+}
+
+/* report a case which took time for repeat times. points or frames is zero if not applicable. */
+static void bench_report(const char *name, double param, int repeat, double time, double points, double frames)
+{
+  double ns = time / repeat * 1.0e9;
+
+  printf( "%s,%.0f,%d,%.0f,", name, param, repeat, ns );
+  if( points > 0 ) printf( "%.3f", ns / points );
+  printf( "," );
+  if( frames > 0 ) printf( "%.3f", frames * repeat / time );
+  printf( ",%ld\n", bench_peak_rss() );
+  fflush( stdout );
+}
+
+/* run a case until BENCH_MIN_TIME elapses, and return the number of repeats. */
+static int bench_run(void (* run)(plotincCanvas *, void *), plotincCanvas *canvas, void *arg, double *time)
+{
+  double start;
+  int repeat;
+
+  start = bench_now();
+  for( repeat=0; repeat<BENCH_MAX_REPEAT; ){
+    run( canvas, arg );
+    repeat++;
+    if( ( *time = bench_now() - start ) >= BENCH_MIN_TIME ) break;
+  }
+  return repeat;
+}
+
+/* data */
+
+typedef struct{
+  double *xdata;
+  double *ydata;
+  int size;
+  plotincDecimation decimation;
+} bench_data;
+
+static void bench_plot_data1d(plotincCanvas *canvas, void *arg)
+{
+  bench_data *data = arg;
+  plotincFramePlotData1DDecimated( plotincCanvasFrame( canvas, 0, 0 ), canvas->cairo, data->ydata, data->size, data->decimation );
+}
+
+static void bench_plot_data2d(plotincCanvas *canvas, void *arg)
+{
+  bench_data *data = arg;
+  plotincFramePlotData2DDecimated( plotincCanvasFrame( canvas, 0, 0 ), canvas->cairo, data->xdata, data->ydata, data->size, data->decimation );
+}
+
+static void bench_case_data(void)
+{
+  const char *name[] = { "plot_data1d", "plot_data1d_m4", "plot_data2d", "plot_data2d_m4" };
+  plotincCanvas canvas;
+  bench_data data;
+  double size, time;
+  int i, k, repeat;
+
+  for( size=1.0e3; size<=bench_max_points; size*=10 ){
+    data.size = size;
+    data.xdata = malloc( sizeof(double)*data.size );
+    data.ydata = malloc( sizeof(double)*data.size );
+    if( !data.xdata || !data.ydata ){
+      fprintf( stderr, "cannot allocate memory for %d points.\n", data.size );
+      free( data.xdata );
+      free( data.ydata );
+      break;
+    }
+    for( i=0; i<data.size; i++ ){
+      data.xdata[i] = i;
+      data.ydata[i] = sin( i * 1.0e-3 ) + 0.1 * sin( i * 0.37 );
+    }
+    for( k=0; k<4; k++ ){
+      if( !bench_fork() ) continue;
+      if( !bench_open( &canvas ) ) exit( EXIT_FAILURE );
+      plotincFrameSetRangeByData2D( plotincCanvasFrame( &canvas, 0, 0 ), data.xdata, data.ydata, data.size );
+      data.decimation = k % 2 ? PLOTINC_DECIMATION_M4 : PLOTINC_DECIMATION_NONE;
+      repeat = bench_run( k < 2 ? bench_plot_data1d : bench_plot_data2d, &canvas, &data, &time );
+      bench_report( name[k], size, repeat, time, size, 0 );
+      bench_close( &canvas );
+      bench_exit();
+    }
+    free( data.xdata );
+    free( data.ydata );
+  }
+}
+
+/* function */
+
+static void bench_plot_function(plotincCanvas *canvas, void *arg)
+{
+  plotincFramePlotFunction( plotincCanvasFrame( canvas, 0, 0 ), canvas->cairo, sin, *(int *)arg );
+}
+
+static void bench_case_function(void)
+{
+  plotincCanvas canvas;
+  plotincFrame *frame;
+  double time;
+  int sample_num, repeat;
+
+  for( sample_num=100; sample_num<=1000000; sample_num*=10 ){
+    if( !bench_fork() ) continue;
+    if( !bench_open( &canvas ) ) exit( EXIT_FAILURE );
+    frame = plotincCanvasFrame( &canvas, 0, 0 );
+    plotincFrameSetXRange( frame, -100, 100 );
+    plotincFrameSetYRange( frame, -1, 1 );
+    repeat = bench_run( bench_plot_function, &canvas, &sample_num, &time );
+    bench_report( "plot_function", sample_num, repeat, time, sample_num, 0 );
+    bench_close( &canvas );
+    bench_exit();
+  }
+}
+
+/* canvas */
+
+static void bench_draw_function(plotincFrame *frame, cairo_t *cairo)
+{
+  plotincFramePlotFunction( frame, cairo, sin, 1000 );
+}
+
+static void bench_draw_canvas(plotincCanvas *canvas, void *arg)
+{
+  plotincCanvasDraw( canvas );
+}
+
+/* draw grids of frames with decorations only or also with functions. */
+static void bench_case_canvas(void)
+{
+  plotincCanvas canvas;
+  plotincFrame *frame;
+  double time;
+  int size, k, i, repeat;
+
+  for( k=0; k<2; k++ )
+    for( size=1; size<=32; size*=2 ){
+      if( !bench_fork() ) continue;
+      if( !bench_open( &canvas ) ) exit( EXIT_FAILURE );
+      plotincCanvasSetGrid( &canvas, size, size );
+      for( i=0; i<canvas.frame_num; i++ ){
+        frame = plotincCanvasFrame( &canvas, i / size, i % size );
+        plotincFrameSetXRange( frame, -10, 10 );
+        plotincFrameSetYRange( frame, -1, 1 );
+        plotincFrameSetXLabel( frame, "x" );
+        plotincFrameSetYLabel( frame, "y" );
+        plotincFrameSetTitle( frame, "frame" );
+        plotincFrameEnableXGrid( frame );
+        plotincFrameEnableYGrid( frame );
+        if( k == 1 ) frame->draw = bench_draw_function;
+      }
+      repeat = bench_run( bench_draw_canvas, &canvas, NULL, &time );
+      bench_report( k == 0 ? "canvas_decoration" : "canvas_function", canvas.frame_num, repeat, time, 0, canvas.frame_num );
+      bench_close( &canvas );
+      bench_exit();
+    }
+}
+
+/* TeX label */
+
+static void bench_case_tex(void)
+{
+  plotincCanvas canvas;
+  plotincFrame *frame;
+  double time;
+  int repeat;
+
+  if( system( "which platex > /dev/null 2>&1" ) != 0 ){
+    fprintf( stderr, "platex not found, TeX labels skipped.\n" );
+    return;
+  }
+  /* the first draw invokes TeX, whose peak RSS is also in that of the cached ones */
+  if( !bench_fork() ) return;
+  if( !bench_open( &canvas ) ) exit( EXIT_FAILURE );
+  frame = plotincCanvasFrame( &canvas, 0, 0 );
+  plotincFrameSetXLabel( frame, "$\\theta$" );
+  plotincFrameSetYLabel( frame, "$\\sin\\theta$" );
+  time = bench_now();
+  plotincCanvasDraw( &canvas );
+  bench_report( "tex_label_cold", 2, 1, bench_now() - time, 0, 1 );
+  /* the following draws hit the cache */
+  repeat = bench_run( bench_draw_canvas, &canvas, NULL, &time );
+  bench_report( "tex_label_cached", 2, repeat, time, 0, 1 );
+  bench_close( &canvas );
+  bench_exit();
+}
+
+static void bench_usage(const char *cmd)
+{
+  fprintf( stderr, "usage: %s [-svg] [-n max_points] [-w width] [-h height]\n", cmd );
+  exit( EXIT_FAILURE );
+}
+
+int main(int argc, char** argv)
+{
+  int i;
+
+  for( i=1; i<argc; i++ ){
+    if( strcmp( argv[i], "-svg" ) == 0 )
+      bench_svg = true;
+    else if( strcmp( argv[i], "-n" ) == 0 && i+1 < argc )
+      bench_max_points = atof( argv[++i] );
+    else if( strcmp( argv[i], "-w" ) == 0 && i+1 < argc )
+      bench_width = atoi( argv[++i] );
+    else if( strcmp( argv[i], "-h" ) == 0 && i+1 < argc )
+      bench_height = atoi( argv[++i] );
+    else
+      bench_usage( argv[0] );
+  }
+  printf( "case,param,repeat,ns_per_repeat,ns_per_point,frames_per_s,peak_rss_kb\n" );
+  bench_case_data();
+  bench_case_function();
+  bench_case_canvas();
+  bench_case_tex();
+  return 0;
+}
@@ -0,0 +1,38 @@
+#include <plotinc/plotinc.h>
+#include <unistd.h>
+
+/* usage: ./animation_test | ffmpeg -i - test.mp4 */
+
+#define STEP_NUM 120
+
+double phase;
+
+double wave(double x)
+{
+  return sin( x - phase );
+}
+
+void draw(plotincFrame *frame, cairo_t *cairo)
+{
+  cairo_set_source_rgb( cairo, 0.8, 0.5, 0.0 );
+  plotincFramePlotFunction( frame, cairo, wave, 1000 );
+}
+
+int main(int argc, char** argv)
+{
+  plotincCanvas canvas;
+  int i;
+
+  if( !plotincCanvasOpenAnimationStream( &canvas, PLOTINC_CANVAS_DEFAULT_WIDTH, PLOTINC_CANVAS_DEFAULT_HEIGHT, PLOTINC_ANIMATION_Y4M, STDOUT_FILENO ) )
+    return 1;
+  canvas.frame_last->draw = draw;
+  plotincFrameSetXLabel( canvas.frame_last, "Label x" );
+  plotincFrameSetYLabel( canvas.frame_last, "Label y" );
+  plotincFrameSetXRange( canvas.frame_last, -2*M_PI, 2*M_PI );
+  plotincFrameSetYRange( canvas.frame_last, -2, 2 );
+  for( i=0; i<STEP_NUM && !plotincCanvasAnimationError( &canvas ); i++ ){
+    phase = 2 * M_PI * i / STEP_NUM;
+    plotincCanvasDraw( &canvas );
+  }
+  return plotincCanvasCloseAnimation( &canvas ) ? 0 : 1;
+}
@@ -0,0 +1,35 @@
+#include <plotinc/plotinc.h>
+
+#define SIZE 100000
+
+double data[SIZE];
+
+void draw(plotincFrame *frame, cairo_t *cairo)
+{
+  cairo_set_source_rgb( cairo, 0.0, 0.5, 0.8 );
+  plotincFramePlotData1D( frame, cairo, data, SIZE );
+}
+
+int main(int argc, char** argv)
+{
+  plotincCanvas canvas;
+  int i;
+
+  /* uniform samples in [0,1) with a far outlier */
+  for( i=0; i<SIZE; i++ )
+    data[i] = (double)rand() / ( (double)RAND_MAX + 1 );
+  data[SIZE/2] = 1.0e12;
+
+  plotincCanvasOpenImage( &canvas, PLOTINC_CANVAS_DEFAULT_WIDTH, PLOTINC_CANVAS_DEFAULT_HEIGHT );
+  canvas.frame_last->draw = draw;
+  plotincFrameSetRangeByData1D( canvas.frame_last, data, SIZE );
+  printf( "y-range: [%g, %g]\n", canvas.frame_last->yaxis.range_min, canvas.frame_last->yaxis.range_max );
+  /* clip 1% of each tail, which leaves the y-range about [0.01, 0.99] */
+  plotincFrameSetRangeClip( canvas.frame_last, 0.01 );
+  plotincFrameSetRangeByData1D( canvas.frame_last, data, SIZE );
+  printf( "y-range clipped: [%g, %g]\n", canvas.frame_last->yaxis.range_min, canvas.frame_last->yaxis.range_max );
+  plotincCanvasDraw( &canvas );
+  plotincCanvasWritePNG( &canvas, "range_clip_test.png" );
+  plotincCanvasCloseImage( &canvas );
+  return 0;
+}
@@ -10,6 +10,8 @@
 #include <stdbool.h>
 #include <string.h>
 #include <math.h>
+#include <stdint.h>
+#include <pthread.h>
 
 #include <X11/Xutil.h>
 #include <X11/Xlib.h>
@@ -20,6 +22,10 @@
 #define PLOTINC_CANVAS_DEFAULT_WIDTH   960
 #define PLOTINC_CANVAS_DEFAULT_HEIGHT  640
 #define PLOTINC_CANVAS_DEFAULT_PADDING   4
+#define PLOTINC_CANVAS_LAYER_MARGIN     16
+
+#define PLOTINC_FRAME_BLOCK_SIZE        16
+#define PLOTINC_FRAME_BLOCK_MAXNUM      24
 
 #define PLOTINC_DEFAULT_FONT_SIZE       16
 #define PLOTINC_BASELINE_MARGIN          4
@@ -32,16 +38,201 @@
 
 #define PLOTINC_TICSLENGTH               6
 #define PLOTINC_FRAMESTR_MAXSIZE       100
+#define PLOTINC_TICSSTR_MAXSIZE         32
+#define PLOTINC_TICSCACHE_MAXSIZE       64
 
 #define PLOTINC_FONTNAME_MAXSIZE       125
+#define PLOTINC_PATH_MAXSIZE           512
 #define PLOTINC_DEFAULT_FONT             "Times New Roman"
 
+#define PLOTINC_LTTB_BUCKETS_PER_PIXEL   2
+#define PLOTINC_TRANSFORM_CHUNK_SIZE  1024
+#define PLOTINC_COORD_LIMIT              1.0e9
+
+#define PLOTINC_RANGE_JOB_MINSIZE  (1<<20)
+#define PLOTINC_RANGE_HISTOGRAM_BITS    12
+#define PLOTINC_RANGE_HISTOGRAM_SIZE  ( 1<<PLOTINC_RANGE_HISTOGRAM_BITS )
+#define PLOTINC_RANGE_CLIP_BIN_NUM    1024
+
+#define PLOTINC_PYRAMID_BLOCK_SHIFT      6
+#define PLOTINC_PYRAMID_MAXLEVEL        26
+#define PLOTINC_PYRAMID_BLOCKS_PER_JOB 4096
+
+#define PLOTINC_SIMPLIFY_TOLERANCE       0.1
+#define PLOTINC_SIMPLIFY_CHUNK_SIZE   4096
+
+#define PLOTINC_ADAPTIVE_MAX_DEPTH      16
+#define PLOTINC_SAMPLING_JOB_SIZE       16
+
+#define PLOTINC_SERIES_LINEWIDTH         1.0
+#define PLOTINC_SCROLL_MARGIN            0.25
+
+#define PLOTINC_COLORMAP_DEFAULT_SIZE  256
+#define PLOTINC_COLORMAP_MAXSIZE      4096
+#define PLOTINC_IMAGE_ROWS_PER_JOB      16
+
+#define PLOTINC_ANIMATION_DEFAULT_RATE  30
+
+/* affine transform from plot coordinates to device coordinates */
+
+typedef struct{
+  double scale;
+  double offset;
+} plotincTransform;
+
+void plotincTransformDoubleArray(const plotincTransform *transform, const double src[], double dst[], int size);
+void plotincTransformFloatArray(const plotincTransform *transform, const float src[], double dst[], int size);
+void plotincTransformDoubleArrayToInt(const plotincTransform *transform, const double src[], int dst[], int size);
+void plotincTransformFloatArrayToInt(const plotincTransform *transform, const float src[], int dst[], int size);
+
+/* decimation of plotted data */
+
+typedef enum{
+  PLOTINC_DECIMATION_NONE = 0, /* plot all samples */
+  PLOTINC_DECIMATION_M4,       /* first, min, max and last sample per pixel column */
+  PLOTINC_DECIMATION_LTTB,     /* largest-triangle-three-buckets, suited for vector outputs */
+} plotincDecimation;
+
+/* column of binary data, namely elements of a type placed at a constant byte stride */
+
+typedef enum{
+  PLOTINC_DATA_DOUBLE = 0,
+  PLOTINC_DATA_FLOAT,
+  PLOTINC_DATA_INT16,
+  PLOTINC_DATA_INT32,
+  PLOTINC_DATA_INT64,
+  PLOTINC_DATA_UINT8,
+  PLOTINC_DATA_UINT16,
+} plotincDataType;
+
+typedef struct{
+  const void *data;
+  plotincDataType type;
+  size_t stride; /* in bytes */
+  int size;      /* number of elements */
+} plotincColumn;
+
+size_t plotincDataTypeSize(plotincDataType type);
+void plotincColumnAssign(plotincColumn *column, plotincDataType type, const void *data, size_t stride, int size);
+
+/* binary file mapped on memory */
+
+typedef struct{
+  int fd;
+  void *map;
+  size_t length;
+} plotincDataSource;
+
+bool plotincDataSourceOpen(plotincDataSource *source, const char *filename);
+void plotincDataSourceClose(plotincDataSource *source);
+bool plotincDataSourceColumn(const plotincDataSource *source, plotincColumn *column, plotincDataType type, size_t offset, size_t stride);
+
+/* pyramid of minima and maxima of 1-dimensional data over blocks, whose
+ * sizes are powers of two from 1<<PLOTINC_PYRAMID_BLOCK_SHIFT */
+
+typedef struct{
+  int size;
+  int capacity;
+  double *min;
+  double *max;
+} plotincPyramidLevel;
+
+typedef struct{
+  plotincColumn column; /* referenced, not copied */
+  int thread_num;
+  int level_num;
+  plotincPyramidLevel level[PLOTINC_PYRAMID_MAXLEVEL];
+} plotincPyramid;
+
+void plotincPyramidInit(plotincPyramid *pyramid);
+void plotincPyramidDestroy(plotincPyramid *pyramid);
+void plotincPyramidSetThreadNum(plotincPyramid *pyramid, int num);
+bool plotincPyramidExtendColumn(plotincPyramid *pyramid, const plotincColumn *column);
+bool plotincPyramidExtend(plotincPyramid *pyramid, const double data[], int size);
+bool plotincPyramidMinMax(const plotincPyramid *pyramid, int from, int to, double *min, double *max);
+
+/* colormap, namely a lookup table from values to colors */
+
+typedef enum{
+  PLOTINC_COLORMAP_GRAY = 0,
+  PLOTINC_COLORMAP_HOT,
+  PLOTINC_COLORMAP_JET,
+  PLOTINC_COLORMAP_VIRIDIS,
+} plotincColormapType;
+
+typedef struct{
+  int size;
+  uint32_t *table; /* ARGB32 colors, followed by a transparent one for NaN */
+  double min;      /* value mapped to the first color */
+  double max;      /* value mapped to the last color */
+} plotincColormap;
+
+bool plotincColormapInit(plotincColormap *colormap, plotincColormapType type, int size);
+void plotincColormapDestroy(plotincColormap *colormap);
+void plotincColormapSetRange(plotincColormap *colormap, double min, double max);
+void plotincColormapApply(const plotincColormap *colormap, const double src[], uint32_t dst[], int size);
+
+/* resampling of images */
+
+typedef enum{
+  PLOTINC_INTERPOLATION_NEAREST = 0,
+  PLOTINC_INTERPOLATION_BILINEAR,
+} plotincInterpolation;
+
+/* scale of density plots */
+
+typedef enum{
+  PLOTINC_DENSITY_LINEAR = 0,
+  PLOTINC_DENSITY_LOG,
+} plotincDensityScale;
+
+/* statistics of drawing frames, collected if the library is built with
+ * PLOTINC_PROFILE defined */
+
+typedef enum{
+  PLOTINC_PHASE_FRAME = 0,  /* whole plotincFrameDraw() */
+  PLOTINC_PHASE_BACKGROUND, /* compositing cached background layers */
+  PLOTINC_PHASE_GRID,
+  PLOTINC_PHASE_TICS,
+  PLOTINC_PHASE_LABEL,      /* labels and titles including TeX labels */
+  PLOTINC_PHASE_TEX,        /* rendering labels by TeX */
+  PLOTINC_PHASE_BORDER,
+  PLOTINC_PHASE_DRAW,       /* drawing method of frames */
+  PLOTINC_PHASE_SERIES,
+  PLOTINC_PHASE_NUM,
+} plotincPhase;
+
+typedef struct{
+  long draw_num;                   /* number of draws */
+  double time[PLOTINC_PHASE_NUM];  /* accumulated durations in seconds */
+  long emit_num;                   /* vertices of paths passed to Cairo */
+  long cull_num;                   /* vertices of paths outside plot regions */
+  long decimate_num;               /* vertices of paths merged by M4 decimation */
+  long simplify_num;               /* vertices of paths removed by simplification */
+  long tex_num;                    /* invocations of TeX */
+  long texcache_hit_num;           /* TeX labels found in caches */
+  long background_hit_num;         /* reuses of cached background layers */
+} plotincStats;
+
 /* axis */
 
+/* formatted tic value with its extents */
+typedef struct{
+  double val;
+  char str[PLOTINC_TICSSTR_MAXSIZE];
+  cairo_text_extents_t te;
+} plotincTicsLabel;
+
+typedef struct{
+  int num;
+  plotincTicsLabel label[PLOTINC_TICSCACHE_MAXSIZE];
+} plotincTicsCache;
+
 typedef struct{
   double range_min;
   double range_max;
   int tics_num;
+  plotincTicsCache *tics_cache; /* filled in while tics are drawn on a const frame */
   char label[PLOTINC_FRAMESTR_MAXSIZE];
   /* flags to draw components */
   bool flag_tics;
@@ -49,8 +240,41 @@ typedef struct{
   bool flag_label;
 } plotincAxis;
 
+/* marker of scatter plots */
+
+typedef enum{
+  PLOTINC_MARKER_CIRCLE = 0,
+  PLOTINC_MARKER_SQUARE,
+  PLOTINC_MARKER_DIAMOND,
+  PLOTINC_MARKER_TRIANGLE,
+} plotincMarker;
+
+/* series of streaming data stored in a ring buffer */
+
+typedef struct _plotincSeries{
+  double *xbuf;
+  double *ybuf;
+  int capacity;
+  int head;  /* index of the oldest sample */
+  int num;   /* number of stored samples */
+  int fresh; /* number of samples appended since the last draw */
+  bool flag_evicted; /* samples are overwritten or cleared since the last draw */
+  double r, g, b;
+  double line_width;
+  /* list */
+  struct _plotincSeries *next;
+} plotincSeries;
+
+void plotincSeriesSetColor(plotincSeries *series, double r, double g, double b);
+void plotincSeriesSetLineWidth(plotincSeries *series, double width);
+void plotincSeriesClear(plotincSeries *series);
+void plotincSeriesAppend(plotincSeries *series, double x, double y);
+void plotincSeriesAppendArray(plotincSeries *series, const double xdata[], const double ydata[], int size);
+
 /* frame */
 
+struct _plotincCanvas;
+
 typedef struct _plotincFrame{
   char title[PLOTINC_FRAMESTR_MAXSIZE];
   /* drawable region */
@@ -67,19 +291,48 @@ typedef struct _plotincFrame{
   char font_name[PLOTINC_FONTNAME_MAXSIZE];
   int font_pts;
   int baseline_skip;
+  cairo_font_face_t *font_face;
+  cairo_scaled_font_t *scaled_font;
+  /* font options of the target and transformation the scaled font is made for */
+  cairo_font_options_t *font_options;
+  cairo_matrix_t font_ctm;
+  /* cached layer of grids, tics, labels, title and border */
+  cairo_surface_t *background;
+  bool flag_background_raster;
   /* plot coordinate region */
   plotincAxis xaxis;
   plotincAxis yaxis;
   plotincAxis y2axis;
   /* drawing method */
   void (* draw)(struct _plotincFrame *, cairo_t *);
+  plotincDecimation decimation;
+  /* tolerance in pixels to simplify paths on vector surfaces, 0 to disable */
+  double simplify_tolerance;
+  /* fraction of data clipped at each tail when ranges are set based on data */
+  double range_clip;
+  /* pyramid of data looked up when ranges are set based on the same data, referenced */
+  const plotincPyramid *pyramid;
+  /* streaming data */
+  plotincSeries *series_list;
+  double scroll_width;
+  bool flag_scroll;
+  /* adaptive sampling of functions */
+  double sampling_tolerance;
+  int sampling_max;
+  bool flag_adaptive;
+  bool flag_parallel_sampling; /* functions plotted are reentrant */
   /* flags to draw components */
   bool flag_title;
+  /* statistics of drawing, null unless profiled */
+  plotincStats *stats;
+  /* canvas which the frame belongs to */
+  struct _plotincCanvas *canvas;
   /* list */
   struct _plotincFrame *next;
 } plotincFrame;
 
 void plotincFrameInit(plotincFrame *frame);
+void plotincFrameDestroy(plotincFrame *frame);
 void plotincFrameSetTitle(plotincFrame *frame, const char *title);
 
 void plotincFrameEnableXTics(plotincFrame *frame);
@@ -106,6 +359,10 @@ void plotincFrameResize(plotincFrame *frame, int ox, int oy, int width, int heig
 
 void plotincFrameSetFont(plotincFrame *frame, int size, char *fontname);
 
+void plotincFrameSetDecimation(plotincFrame *frame, plotincDecimation decimation);
+void plotincFrameSetSimplifyTolerance(plotincFrame *frame, double tolerance);
+void plotincFrameSetRangeClip(plotincFrame *frame, double fraction);
+
 void plotincFrameSetXRange(plotincFrame *frame, double min, double max);
 void plotincFrameSetYRange(plotincFrame *frame, double min, double max);
 void plotincFrameSetY2Range(plotincFrame *frame, double min, double max);
@@ -114,6 +371,10 @@ void plotincFrameSetXLabel(plotincFrame *frame, const char *label);
 void plotincFrameSetYLabel(plotincFrame *frame, const char *label);
 void plotincFrameSetY2Label(plotincFrame *frame, const char *label);
 
+plotincTransform plotincFrameXTransform(const plotincFrame *frame);
+plotincTransform plotincFrameYTransform(const plotincFrame *frame);
+plotincTransform plotincFrameY2Transform(const plotincFrame *frame);
+
 int plotincFrameXCoord(const plotincFrame *frame, double x);
 int plotincFrameYCoord(const plotincFrame *frame, double y);
 int plotincFrameY2Coord(const plotincFrame *frame, double y);
@@ -132,47 +393,174 @@ void plotincFrameDrawY2Grid(const plotincFrame *frame, cairo_t *cairo);
 
 void plotincFrameDraw(plotincFrame *frame, cairo_t *cairo);
 
+bool plotincFrameStats(const plotincFrame *frame, plotincStats *stats);
+
 void plotincFrameDrawPoint(const plotincFrame *frame, cairo_t *cairo, double x, double y, double size);
 void plotincFrameDrawLine(const plotincFrame *frame, cairo_t *cairo, double x0, double y0, double x1, double y1);
 
+void plotincFramePlotScatter(const plotincFrame *frame, cairo_t *cairo, const double xdata[], const double ydata[], int size, plotincMarker marker, double marker_size);
+
 void plotincFrameSetRangeByData1D(plotincFrame *frame, const double data[], int size);
 void plotincFramePlotData1D(const plotincFrame *frame, cairo_t *cairo, const double data[], int size);
+void plotincFramePlotData1DDecimated(const plotincFrame *frame, cairo_t *cairo, const double data[], int size, plotincDecimation decimation);
 
 void plotincFrameSetRangeByData2D(plotincFrame *frame, const double xdata[], const double ydata[], int size);
 void plotincFramePlotData2D(const plotincFrame *frame, cairo_t *cairo, const double xdata[], const double ydata[], int size);
+void plotincFramePlotData2DDecimated(const plotincFrame *frame, cairo_t *cairo, const double xdata[], const double ydata[], int size, plotincDecimation decimation);
+
+void plotincFrameSetRangeByTypedData1D(plotincFrame *frame, plotincDataType type, const void *data, size_t stride, int size);
+void plotincFramePlotTypedData1D(const plotincFrame *frame, cairo_t *cairo, plotincDataType type, const void *data, size_t stride, int size);
+
+void plotincFrameSetRangeByTypedData2D(plotincFrame *frame, plotincDataType xtype, const void *xdata, size_t xstride, plotincDataType ytype, const void *ydata, size_t ystride, int size);
+void plotincFramePlotTypedData2D(const plotincFrame *frame, cairo_t *cairo, plotincDataType xtype, const void *xdata, size_t xstride, plotincDataType ytype, const void *ydata, size_t ystride, int size);
+
+void plotincFramePlotImage(const plotincFrame *frame, cairo_t *cairo, plotincDataType type, const void *data, int rows, int cols, double xmin, double xmax, double ymin, double ymax, const plotincColormap *colormap, plotincInterpolation interpolation);
+
+void plotincFramePlotDensity2D(const plotincFrame *frame, cairo_t *cairo, const double xdata[], const double ydata[], int size, const plotincColormap *colormap, plotincDensityScale scale);
+void plotincFramePlotDensityColumn2D(const plotincFrame *frame, cairo_t *cairo, const plotincColumn *xcolumn, const plotincColumn *ycolumn, const plotincColormap *colormap, plotincDensityScale scale);
+
+void plotincFrameSetRangeByColumn1D(plotincFrame *frame, const plotincColumn *column);
+void plotincFramePlotColumn1D(const plotincFrame *frame, cairo_t *cairo, const plotincColumn *column);
+
+void plotincFrameSetRangeByColumn2D(plotincFrame *frame, const plotincColumn *xcolumn, const plotincColumn *ycolumn);
+void plotincFramePlotColumn2D(const plotincFrame *frame, cairo_t *cairo, const plotincColumn *xcolumn, const plotincColumn *ycolumn);
+
+void plotincFrameSetPyramid(plotincFrame *frame, const plotincPyramid *pyramid);
+void plotincFrameSetRangeByPyramid(plotincFrame *frame, const plotincPyramid *pyramid, int from, int to);
+void plotincFramePlotPyramid(const plotincFrame *frame, cairo_t *cairo, const plotincPyramid *pyramid);
+
+plotincSeries *plotincFrameAddSeries(plotincFrame *frame, int capacity);
+void plotincFrameEnableAutoScroll(plotincFrame *frame, double width);
+void plotincFrameDisableAutoScroll(plotincFrame *frame);
+void plotincFrameDrawSeries(const plotincFrame *frame, cairo_t *cairo);
+bool plotincFrameUpdateSeries(const plotincFrame *frame, cairo_t *cairo);
+
+void plotincFrameEnableAdaptiveSampling(plotincFrame *frame, double tolerance, int max_num);
+void plotincFrameDisableAdaptiveSampling(plotincFrame *frame);
+void plotincFrameEnableParallelSampling(plotincFrame *frame);
+void plotincFrameDisableParallelSampling(plotincFrame *frame);
+
+/* function evaluated for an array of n arguments at once, with a context */
+typedef void (* plotincBatchFunction)(void *ctx, const double t[], double out[], size_t n);
 
 void plotincFramePlotParametricFunction(const plotincFrame *frame, cairo_t *cairo, double (* xfunction)(double), double (* yfunction)(double), double param_min, double param_max, int sample_num);
+void plotincFramePlotParametricFunctionCtx(const plotincFrame *frame, cairo_t *cairo, double (* xfunction)(void *, double), double (* yfunction)(void *, double), void *ctx, double param_min, double param_max, int sample_num);
+void plotincFramePlotParametricFunctionBatch(const plotincFrame *frame, cairo_t *cairo, plotincBatchFunction xfunction, plotincBatchFunction yfunction, void *ctx, double param_min, double param_max, int sample_num);
 void plotincFramePlotFunction(const plotincFrame *frame, cairo_t *cairo, double (* function)(double), int sample_num);
+void plotincFramePlotFunctionCtx(const plotincFrame *frame, cairo_t *cairo, double (* function)(void *, double), void *ctx, int sample_num);
+void plotincFramePlotFunctionBatch(const plotincFrame *frame, cairo_t *cairo, plotincBatchFunction function, void *ctx, int sample_num);
 
 /* canvas */
 
+/* animation written step by step from a canvas */
+typedef enum{
+  PLOTINC_ANIMATION_PNG = 0, /* numbered PNG files */
+  PLOTINC_ANIMATION_Y4M,     /* YUV4MPEG2 stream in 4:4:4 */
+  PLOTINC_ANIMATION_RGBA,    /* raw stream of 8-bit RGBA pixels */
+} plotincAnimationFormat;
+
 typedef struct{
+  plotincAnimationFormat format;
+  char pattern[PLOTINC_PATH_MAXSIZE]; /* printf-format of PNG file names */
+  int fd;                             /* file descriptor of a stream */
+  int rate;                           /* frames per second of a Y4M stream */
+  /* double buffers, one drawn by the canvas while the other is written */
+  cairo_surface_t *buffer[2];
+  cairo_t *cairo[2];
+  int current;      /* buffer drawn by the canvas */
+  int pending;      /* buffer passed to the writer, -1 if none */
+  int step;         /* number of steps written */
+  unsigned char *data; /* converted pixels of a step */
+  bool flag_quit;
+  bool flag_error; /* any step failed to be written */
+  pthread_t writer;
+  pthread_mutex_t mutex;
+  pthread_cond_t cond;
+} plotincAnimation;
+
+/* label rendered by TeX */
+typedef struct _plotincTexLabel{
+  char label[PLOTINC_FRAMESTR_MAXSIZE];
+  cairo_surface_t *image; /* null if failed to be rendered */
+  /* list */
+  struct _plotincTexLabel *next;
+} plotincTexLabel;
+
+typedef struct _plotincCanvas{
   Display *display;
   Window win;
   XEvent event;
-
+  /* window surface on which the back buffer is presented and
+   * the thread to handle events of the window on its own connection, so
+   * that each connection is used by one thread at a time without XInitThreads() */
+  cairo_surface_t *window_surface;
+  Display *event_display;
+  pthread_t event_thread;
+
+  /* target surface (the back buffer on X-Window system) */
   cairo_surface_t *surface;
   cairo_t *cairo;
 
   int width;
   int height;
+  /* size of the window resized on X-Window system, applied to frames on the
+   * next draw, and whether the application is requested to redraw the canvas */
+  int resize_width;
+  int resize_height;
+  bool flag_resize;
+  bool flag_redraw;
 
   int row_size;
   int col_size;
+  /* frames in row-major order of the grid, linked from the first one and
+   * pooled in blocks of sizes doubling from PLOTINC_FRAME_BLOCK_SIZE, which
+   * are never reallocated so that frames stay at the same addresses */
   int frame_num;
+  int frame_capacity;
+  int frame_block_num;
+  plotincFrame *frame_block[PLOTINC_FRAME_BLOCK_MAXNUM];
   plotincFrame *frame_list;
   plotincFrame *frame_last;
+
+  /* number of threads to draw contents of frames in parallel on image
+   * surfaces, with the same pixels as drawn serially */
+  int thread_num;
+
+  /* cache of labels rendered by TeX */
+  plotincTexLabel *texlabel_list;
+  char texcache_dir[PLOTINC_PATH_MAXSIZE];
+  pthread_mutex_t texcache_mutex;
+
+  /* lock of drawing against the event thread */
+  pthread_mutex_t mutex;
+
+  /* file to which statistics of drawing are dumped on close */
+  char stats_file[PLOTINC_PATH_MAXSIZE];
+
+  /* animation written on every draw, null unless the canvas is on an animation */
+  plotincAnimation *animation;
 } plotincCanvas;
 
 void plotincCanvasDestroyFrame(plotincCanvas *canvas);
 
 void plotincCanvasResize(plotincCanvas *canvas, int width, int height);
 
+void plotincCanvasSetThreadNum(plotincCanvas *canvas, int num);
+void plotincCanvasSetTexCacheDir(plotincCanvas *canvas, const char *dir);
+
+bool plotincCanvasStats(const plotincCanvas *canvas, plotincStats *stats);
+void plotincCanvasResetStats(plotincCanvas *canvas);
+void plotincCanvasSetStatsFile(plotincCanvas *canvas, const char *filename);
+
 bool plotincCanvasAddRowFrame(plotincCanvas *canvas);
 bool plotincCanvasAddColFrame(plotincCanvas *canvas);
+bool plotincCanvasSetGrid(plotincCanvas *canvas, int row_size, int col_size);
+plotincFrame *plotincCanvasFrame(const plotincCanvas *canvas, int row, int col);
 
 void plotincCanvasClear(plotincCanvas *canvas);
 void plotincCanvasDraw(plotincCanvas *canvas);
+void plotincCanvasDrawUpdate(plotincCanvas *canvas);
+bool plotincCanvasNeedsRedraw(plotincCanvas *canvas);
 
 bool plotincCanvasOpenX11(plotincCanvas *canvas, int width, int height);
 void plotincCanvasCloseX11(plotincCanvas *canvas);
@@ -180,4 +568,15 @@ void plotincCanvasCloseX11(plotincCanvas *canvas);
 bool plotincCanvasOpenSVG(plotincCanvas *canvas, int width, int height, const char *filename);
 void plotincCanvasCloseSVG(plotincCanvas *canvas);
 
+bool plotincCanvasOpenImage(plotincCanvas *canvas, int width, int height);
+void plotincCanvasCloseImage(plotincCanvas *canvas);
+unsigned char *plotincCanvasImageData(plotincCanvas *canvas, int *stride);
+bool plotincCanvasWritePNG(plotincCanvas *canvas, const char *filename);
+
+bool plotincCanvasOpenAnimation(plotincCanvas *canvas, int width, int height, const char *pattern);
+bool plotincCanvasOpenAnimationStream(plotincCanvas *canvas, int width, int height, plotincAnimationFormat format, int fd);
+void plotincCanvasSetAnimationRate(plotincCanvas *canvas, int rate);
+bool plotincCanvasAnimationError(plotincCanvas *canvas);
+bool plotincCanvasCloseAnimation(plotincCanvas *canvas);
+
 #endif /* __PLOTINC_H__ */
@@ -1,5 +1,17 @@
 #include <plotinc/plotinc.h>
 #include <unistd.h>
+#include <stdint.h>
+#include <limits.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <errno.h>
+
+#if defined(__x86_64__) || ( defined(__i386__) && defined(__SSE2__) )
+#define PLOTINC_SIMD_X86
+#include <immintrin.h>
+#endif
 
 /* axis */
 
@@ -7,9 +19,14 @@ static bool _plotincAxisZeroIsIncluded(const plotincAxis *axis){
   return axis->range_min < 0 && axis->range_max > 0;
 }
 
+static void _plotincAxisClearTicsCache(plotincAxis *axis){
+  if( axis->tics_cache ) axis->tics_cache->num = 0;
+}
+
 static void _plotincAxisSetRange(plotincAxis *axis, double min, double max){
   axis->range_min = min;
   axis->range_max = max;
+  _plotincAxisClearTicsCache( axis );
 }
 
 static void _plotincAxisSetTicsNum(plotincAxis *axis, int num){
@@ -27,6 +44,7 @@ static void _plotincAxisSetLabel(plotincAxis *axis, const char *label){
 }
 
 static void _plotincAxisInit(plotincAxis *axis){
+  axis->tics_cache = NULL;
   _plotincAxisSetRange( axis, -10, 10 );
   _plotincAxisSetTicsNum( axis, PLOTINC_DEFAULT_TICS_NUM );
   _plotincAxisSetLabel( axis, NULL );
@@ -38,10 +56,6 @@ static double _plotincAxisVal(const plotincAxis *axis, double ratio){
   return axis->range_min + ( axis->range_max - axis->range_min ) * ratio;
 }
 
-static double _plotincAxisValRatio(const plotincAxis *axis, double val){
-  return ( val - axis->range_min ) / ( axis->range_max - axis->range_min );
-}
-
 static double _plotincAxisTicsWidth(const plotincAxis *axis){
   double w;
   int n;
@@ -55,865 +69,5027 @@ static double _plotincAxisTicsVal(const plotincAxis *axis, double tics_width, in
   return ceil( axis->range_min / tics_width + i ) * tics_width;
 }
 
-/* frame */
+/* parallel */
 
-/* initialize a frame. */
-void plotincFrameInit(plotincFrame *frame)
+/* whether the running thread is a worker of _plotincParallel(), which does not nest. */
+static __thread bool _plotinc_in_worker = false;
+
+typedef struct{
+  void (* job)(void *, int);
+  void *arg;
+  int num;
+  int next;
+  pthread_mutex_t mutex;
+} _plotincParallelQueue;
+
+static void *_plotincParallelWorker(void *arg)
 {
-  frame->title[0] = '\0';
-  plotincFrameSetFont( frame, PLOTINC_DEFAULT_FONT_SIZE, PLOTINC_DEFAULT_FONT );
-  plotincFrameResize( frame, 0, 0, 0, 0 );
-  _plotincAxisInit( &frame->xaxis );
-  _plotincAxisInit( &frame->yaxis );
-  _plotincAxisInit( &frame->y2axis );
-  plotincFrameEnableXTics( frame );
-  plotincFrameEnableYTics( frame );
-  frame->draw = NULL;
-  frame->flag_title = false;
-  frame->next = NULL;
+  _plotincParallelQueue *queue = arg;
+  bool flag_in_worker;
+  int i;
+
+  flag_in_worker = _plotinc_in_worker;
+  _plotinc_in_worker = true;
+  while( 1 ){
+    pthread_mutex_lock( &queue->mutex );
+    i = queue->next++;
+    pthread_mutex_unlock( &queue->mutex );
+    if( i >= queue->num ) break;
+    queue->job( queue->arg, i );
+  }
+  _plotinc_in_worker = flag_in_worker;
+  return NULL;
 }
 
-void plotincFrameSetTitle(plotincFrame *frame, const char *title)
+/* run jobs indexed from 0 to num-1 on thread_num threads including the calling one.
+ * Jobs run serially when called from a worker. */
+static void _plotincParallel(int thread_num, int num, void (* job)(void *, int), void *arg)
 {
-  if( title && title[0] ){
-    strncpy( frame->title, title, PLOTINC_FRAMESTR_MAXSIZE-1 );
-    frame->flag_title = true;
-  } else{
-    frame->title[0] = '\0';
-    frame->flag_title = false;
+  _plotincParallelQueue queue;
+  pthread_t *threads;
+  int i, n;
+
+  if( thread_num > num ) thread_num = num;
+  if( thread_num <= 1 || _plotinc_in_worker ||
+      !( threads = malloc( sizeof(pthread_t)*( thread_num - 1 ) ) ) ){
+    for( i=0; i<num; i++ ) job( arg, i );
+    return;
   }
+  queue.job = job;
+  queue.arg = arg;
+  queue.num = num;
+  queue.next = 0;
+  pthread_mutex_init( &queue.mutex, NULL );
+  for( n=0; n<thread_num-1; n++ )
+    if( pthread_create( &threads[n], NULL, _plotincParallelWorker, &queue ) != 0 ) break;
+  _plotincParallelWorker( &queue );
+  for( i=0; i<n; i++ )
+    pthread_join( threads[i], NULL );
+  pthread_mutex_destroy( &queue.mutex );
+  free( threads );
 }
 
-void plotincFrameEnableXTics(plotincFrame *frame){ frame->xaxis.flag_tics = true; }
-void plotincFrameEnableXGrid(plotincFrame *frame){ frame->xaxis.flag_grid = true; }
-void plotincFrameEnableYTics(plotincFrame *frame){ frame->yaxis.flag_tics = true; }
-void plotincFrameEnableYGrid(plotincFrame *frame){ frame->yaxis.flag_grid = true; }
-void plotincFrameEnableY2Tics(plotincFrame *frame){ frame->y2axis.flag_tics = true; }
-void plotincFrameEnableY2Grid(plotincFrame *frame){ frame->y2axis.flag_grid = true; }
+/* profile */
 
-void plotincFrameDisableXTics(plotincFrame *frame){ frame->xaxis.flag_tics = false; }
-void plotincFrameDisableXGrid(plotincFrame *frame){ frame->xaxis.flag_grid = false; }
-void plotincFrameDisableYTics(plotincFrame *frame){ frame->yaxis.flag_tics = false; }
-void plotincFrameDisableYGrid(plotincFrame *frame){ frame->yaxis.flag_grid = false; }
-void plotincFrameDisableY2Tics(plotincFrame *frame){ frame->y2axis.flag_tics = false; }
-void plotincFrameDisableY2Grid(plotincFrame *frame){ frame->y2axis.flag_grid = false; }
+#ifdef PLOTINC_PROFILE
+/* statistics of the frame being drawn on the running thread */
+static __thread plotincStats *_plotinc_stats = NULL;
 
-/* resize a frame. */
-void plotincFrameResize(plotincFrame *frame, int ox, int oy, int width, int height)
+static double _plotincClock(void)
 {
-  frame->baseline_skip = frame->font_pts * 4.0 / 3.0; /* assuming 96ppi */
-  frame->ox = ox;
-  frame->oy = oy;
-  frame->width = width;
-  frame->height = height;
-  frame->plot_ox = ox + frame->baseline_skip * 2 + PLOTINC_BASELINE_MARGIN;
-  frame->plot_oy = oy + frame->baseline_skip + PLOTINC_BASELINE_MARGIN;
-  frame->plot_width = frame->width - frame->baseline_skip * 4 - PLOTINC_BASELINE_MARGIN * 2;
-  frame->plot_height = frame->height - frame->baseline_skip * 3 - PLOTINC_BASELINE_MARGIN * 2;
+  struct timespec ts;
+
+  clock_gettime( CLOCK_MONOTONIC, &ts );
+  return ts.tv_sec + ts.tv_nsec * 1.0e-9;
 }
 
-/* set font of a frame. */
-void plotincFrameSetFont(plotincFrame *frame, int size, char *fontname)
+#define PLOTINC_PROFILE_COUNT(member,n) do{ if( _plotinc_stats ) _plotinc_stats->member += (n); } while(0)
+#define PLOTINC_PROFILE_BEGIN(t)        double t = _plotincClock()
+#define PLOTINC_PROFILE_END(t,phase)    do{ if( _plotinc_stats ) _plotinc_stats->time[phase] += _plotincClock() - (t); } while(0)
+#else
+#define PLOTINC_PROFILE_COUNT(member,n)
+#define PLOTINC_PROFILE_BEGIN(t)
+#define PLOTINC_PROFILE_END(t,phase)
+#endif /* PLOTINC_PROFILE */
+
+/* whether a surface is rasterized. */
+static bool _plotincSurfaceIsRaster(cairo_surface_t *surface)
 {
-  frame->font_pts = size;
-  strncpy( frame->font_name, fontname, PLOTINC_FONTNAME_MAXSIZE-1 );
+  switch( cairo_surface_get_type( surface ) ){
+  case CAIRO_SURFACE_TYPE_IMAGE:
+  case CAIRO_SURFACE_TYPE_XLIB:
+  case CAIRO_SURFACE_TYPE_XCB:
+    return true;
+  default:
+    return false;
+  }
 }
 
-/* set x-range of a frame. */
-void plotincFrameSetXRange(plotincFrame *frame, double min, double max)
+/* whether the transformation of a context is an integer translation, under
+ * which pixels copied from an offscreen surface coincide with those drawn directly. */
+static bool _plotincIsPixelAligned(cairo_t *cairo)
 {
-  _plotincAxisSetRange( &frame->xaxis, min, max );
+  cairo_matrix_t m;
+
+  cairo_get_matrix( cairo, &m );
+  return m.xx == 1 && m.yy == 1 && m.xy == 0 && m.yx == 0 &&
+         m.x0 == floor( m.x0 ) && m.y0 == floor( m.y0 );
 }
 
-/* set y-range of a frame. */
-void plotincFrameSetYRange(plotincFrame *frame, double min, double max)
+/* path */
+
+/* a stream of vertices stroked as a polyline, culled, optionally decimated
+ * and simplified on the way. */
+typedef struct{
+  cairo_t *cairo;
+  plotincDecimation decimation;
+  bool flag_open;
+  /* plot region expanded by the margin of strokes, outside of which segments are culled */
+  double xmin, ymin, xmax, ymax;
+  bool flag_prev;
+  double x_prev, y_prev;
+  int code_prev;
+  /* pixel column being aggregated in M4 decimation */
+  bool flag_column;
+  double column;
+  double y_first, y_min, y_max, y_last;
+  bool flag_min_first;
+  /* chunk of vertices being simplified by Douglas-Peucker algorithm */
+  double tolerance;
+  double *xbuf, *ybuf;
+  int *stack;
+  bool *keep;
+  int num;
+#ifdef PLOTINC_PROFILE
+  long emit_num, cull_num, decimate_num, simplify_num;
+  int column_num; /* vertices aggregated in the pixel column */
+#endif
+} _plotincPath;
+
+/* initialize a path on a context. Segments are culled against the plot
+ * region of a frame expanded by the extent of joins and caps of strokes.
+ * Paths on vector surfaces are simplified within the tolerance of a frame,
+ * which does not change rasterized results. */
+static void _plotincPathInit(_plotincPath *path, const plotincFrame *frame, cairo_t *cairo, plotincDecimation decimation)
 {
-  _plotincAxisSetRange( &frame->yaxis, min, max );
+  size_t size = PLOTINC_SIMPLIFY_CHUNK_SIZE;
+  double margin;
+
+  path->cairo = cairo;
+  path->decimation = decimation;
+  path->flag_open = false;
+  margin = 0.5 * cairo_get_line_width( cairo );
+  if( cairo_get_line_join( cairo ) == CAIRO_LINE_JOIN_MITER )
+    margin *= cairo_get_miter_limit( cairo );
+  margin += 1;
+  /* normalized as the clip rectangle of a frame even if it is degenerated */
+  path->xmin = fmin( frame->plot_ox, frame->plot_ox + frame->plot_width ) - margin;
+  path->ymin = fmin( frame->plot_oy, frame->plot_oy + frame->plot_height ) - margin;
+  path->xmax = fmax( frame->plot_ox, frame->plot_ox + frame->plot_width ) + margin;
+  path->ymax = fmax( frame->plot_oy, frame->plot_oy + frame->plot_height ) + margin;
+  path->flag_prev = false;
+  path->flag_column = false;
+  path->tolerance = 0;
+  path->xbuf = NULL;
+  path->num = 0;
+  if( frame->simplify_tolerance > 0 && !_plotincSurfaceIsRaster( cairo_get_target( cairo ) ) ){
+    /* a single block for coordinates, the stack of pairs of indices and flags */
+    if( ( path->xbuf = malloc( ( 2*sizeof(double) + 2*sizeof(int) + sizeof(bool) ) * size ) ) ){
+      path->ybuf = path->xbuf + size;
+      path->stack = (int *)( path->ybuf + size );
+      path->keep = (bool *)( path->stack + 2*size );
+      path->tolerance = frame->simplify_tolerance;
+    }
+  }
+#ifdef PLOTINC_PROFILE
+  path->emit_num = path->cull_num = path->decimate_num = path->simplify_num = 0;
+#endif
 }
 
-/* set y2-range of a frame. */
-void plotincFrameSetY2Range(plotincFrame *frame, double min, double max)
+/* pass a vertex to Cairo. */
+static void _plotincPathLineTo(_plotincPath *path, double x, double y)
 {
-  _plotincAxisSetRange( &frame->y2axis, min, max );
+#ifdef PLOTINC_PROFILE
+  path->emit_num++;
+#endif
+  if( path->flag_open )
+    cairo_line_to( path->cairo, x, y );
+  else{
+    cairo_move_to( path->cairo, x, y );
+    path->flag_open = true;
+  }
 }
 
-/* recall font of a frame. */
-static void _plotincFrameRecallFont(const plotincFrame *frame, cairo_t *cairo)
+/* squared distance from a point to a line segment. */
+static double _plotincSegmentDist2(double x, double y, double x0, double y0, double x1, double y1)
 {
-  cairo_set_source_rgb( cairo, 0, 0, 0 ); /* black */
-  cairo_set_font_size( cairo, frame->font_pts );
-  cairo_select_font_face( cairo, frame->font_name, CAIRO_FONT_SLANT_NORMAL, CAIRO_FONT_WEIGHT_NORMAL );
+  double dx, dy, t, l2;
+
+  dx = x1 - x0;
+  dy = y1 - y0;
+  if( ( l2 = dx*dx + dy*dy ) > 0 ){
+    t = ( ( x - x0 ) * dx + ( y - y0 ) * dy ) / l2;
+    if( t > 1 ){
+      x0 = x1; y0 = y1;
+    } else
+    if( t > 0 ){
+      x0 += t * dx; y0 += t * dy;
+    }
+  }
+  return ( x - x0 ) * ( x - x0 ) + ( y - y0 ) * ( y - y0 );
 }
 
-/* set x-label of a frame. */
-void plotincFrameSetXLabel(plotincFrame *frame, const char *label)
+/* simplify the buffered chunk of a path by Douglas-Peucker algorithm, and pass
+ * the kept vertices to Cairo. The last vertex is retained as the first one of
+ * the next chunk unless the chunk is the last. */
+static void _plotincPathFlushChunk(_plotincPath *path, bool flag_last)
 {
-  _plotincAxisSetLabel( &frame->xaxis, label );
+  double tol2, d, d_max;
+  int sp, first, last, i, i_max, n;
+
+  if( ( n = path->num ) == 0 ) return;
+  tol2 = path->tolerance * path->tolerance;
+  memset( path->keep, 0, sizeof(bool)*n );
+  path->keep[0] = path->keep[n-1] = true;
+  sp = 0;
+  if( n > 2 ){
+    path->stack[sp++] = 0;
+    path->stack[sp++] = n - 1;
+  }
+  while( sp > 0 ){
+    last = path->stack[--sp];
+    first = path->stack[--sp];
+    for( d_max=-1, i_max=first, i=first+1; i<last; i++ )
+      if( ( d = _plotincSegmentDist2( path->xbuf[i], path->ybuf[i], path->xbuf[first], path->ybuf[first], path->xbuf[last], path->ybuf[last] ) ) > d_max ){
+        d_max = d;
+        i_max = i;
+      }
+    if( d_max <= tol2 ) continue;
+    path->keep[i_max] = true;
+    if( i_max - first > 1 ){
+      path->stack[sp++] = first;
+      path->stack[sp++] = i_max;
+    }
+    if( last - i_max > 1 ){
+      path->stack[sp++] = i_max;
+      path->stack[sp++] = last;
+    }
+  }
+  for( i=0; i<n-1; i++ )
+    if( path->keep[i] ) _plotincPathLineTo( path, path->xbuf[i], path->ybuf[i] );
+#ifdef PLOTINC_PROFILE
+    else path->simplify_num++;
+#endif
+  if( flag_last ){
+    _plotincPathLineTo( path, path->xbuf[n-1], path->ybuf[n-1] );
+    path->num = 0;
+  } else{
+    path->xbuf[0] = path->xbuf[n-1];
+    path->ybuf[0] = path->ybuf[n-1];
+    path->num = 1;
+  }
 }
 
-/* set y-label of a frame. */
-void plotincFrameSetYLabel(plotincFrame *frame, const char *label)
+static void _plotincPathEmit(_plotincPath *path, double x, double y)
 {
-  _plotincAxisSetLabel( &frame->yaxis, label );
+  if( path->tolerance <= 0 ){
+    _plotincPathLineTo( path, x, y );
+    return;
+  }
+  if( path->num == PLOTINC_SIMPLIFY_CHUNK_SIZE )
+    _plotincPathFlushChunk( path, false );
+  path->xbuf[path->num] = x;
+  path->ybuf[path->num] = y;
+  path->num++;
 }
 
-/* set y2-label of a frame. */
-void plotincFrameSetY2Label(plotincFrame *frame, const char *label)
+/* flush a pixel column as first, min, max and last vertices in the order of appearance. */
+static void _plotincPathFlushColumn(_plotincPath *path)
 {
-  _plotincAxisSetLabel( &frame->y2axis, label );
+  double y1, y2;
+
+  if( !path->flag_column ) return;
+  path->flag_column = false;
+  if( path->flag_min_first ){
+    y1 = path->y_min; y2 = path->y_max;
+  } else{
+    y1 = path->y_max; y2 = path->y_min;
+  }
+  _plotincPathEmit( path, path->column, path->y_first );
+  if( y1 != path->y_first ) _plotincPathEmit( path, path->column, y1 );
+  if( y2 != y1 ) _plotincPathEmit( path, path->column, y2 );
+  if( path->y_last != y2 ) _plotincPathEmit( path, path->column, path->y_last );
+#ifdef PLOTINC_PROFILE
+  path->decimate_num += path->column_num - 1 - ( y1 != path->y_first ) - ( y2 != y1 ) - ( path->y_last != y2 );
+#endif
 }
 
-/* convert a double-precision value to x-component of coordinates. */
-int plotincFrameXCoord(const plotincFrame *frame, double x)
+static void _plotincPathDecimate(_plotincPath *path, double x, double y)
 {
-  return frame->plot_ox + frame->plot_width * _plotincAxisValRatio( &frame->xaxis, x );
+  if( path->decimation != PLOTINC_DECIMATION_M4 ){
+    _plotincPathEmit( path, x, y );
+    return;
+  }
+  if( path->flag_column && x == path->column ){
+    if( y < path->y_min ){
+      path->y_min = y;
+      path->flag_min_first = false;
+    }
+    if( y > path->y_max ){
+      path->y_max = y;
+      path->flag_min_first = true;
+    }
+    path->y_last = y;
+#ifdef PLOTINC_PROFILE
+    path->column_num++;
+#endif
+    return;
+  }
+  _plotincPathFlushColumn( path );
+  path->flag_column = true;
+  path->column = x;
+  path->y_first = path->y_min = path->y_max = path->y_last = y;
+  path->flag_min_first = true;
+#ifdef PLOTINC_PROFILE
+  path->column_num = 1;
+#endif
 }
 
-/* convert a double-precision value to y-component of coordinates. */
-int plotincFrameYCoord(const plotincFrame *frame, double y)
+/* end the current subpath, so that the next vertex starts a new one. */
+static void _plotincPathBreak(_plotincPath *path)
 {
-  return frame->plot_oy + frame->plot_height * ( 1 - _plotincAxisValRatio( &frame->yaxis, y ) );
+  _plotincPathFlushColumn( path );
+  if( path->tolerance > 0 ) _plotincPathFlushChunk( path, true );
+  path->flag_open = false;
 }
 
-/* convert a double-precision value to y2-component of coordinates. */
-int plotincFrameY2Coord(const plotincFrame *frame, double y)
+/* region code of a vertex against the culling region of a path. */
+static int _plotincPathOutCode(const _plotincPath *path, double x, double y)
 {
-  return frame->plot_oy + frame->plot_height * ( 1 - _plotincAxisValRatio( &frame->y2axis, y ) );
+  return ( x < path->xmin ? 1 : x > path->xmax ? 2 : 0 ) |
+         ( y < path->ymin ? 4 : y > path->ymax ? 8 : 0 );
 }
 
-/* draw title of a frame. */
-void plotincFrameDrawTitle(const plotincFrame *frame, cairo_t *cairo)
+/* clip a segment against the culling region of a path by Liang-Barsky
+ * algorithm. The visible part is between parameters t0 and t1. */
+static bool _plotincPathClipSegment(const _plotincPath *path, double x0, double y0, double x1, double y1, double *t0, double *t1)
 {
-  cairo_text_extents_t te;
+  double p[4], q[4], r;
+  int i;
 
-  if( frame->title[0] ){
-    _plotincFrameRecallFont( frame, cairo );
-    cairo_text_extents( cairo, frame->title, &te );
-    cairo_move_to( cairo,
-      frame->plot_ox + ( frame->plot_width - te.width ) / 2,
-      frame->plot_oy - PLOTINC_BASELINE_MARGIN );
-    cairo_show_text( cairo, frame->title );
+  p[0] = x0 - x1; q[0] = x0 - path->xmin;
+  p[1] = x1 - x0; q[1] = path->xmax - x0;
+  p[2] = y0 - y1; q[2] = y0 - path->ymin;
+  p[3] = y1 - y0; q[3] = path->ymax - y0;
+  *t0 = 0; *t1 = 1;
+  for( i=0; i<4; i++ ){
+    if( p[i] == 0 ){
+      if( q[i] < 0 ) return false;
+      continue;
+    }
+    r = q[i] / p[i];
+    if( p[i] < 0 ){
+      if( r > *t1 ) return false;
+      if( r > *t0 ) *t0 = r;
+    } else{
+      if( r < *t0 ) return false;
+      if( r < *t1 ) *t1 = r;
+    }
   }
+  return true;
 }
 
-/* draw border lines of a frame. */
-void plotincFrameDrawBorder(const plotincFrame *frame, cairo_t *cairo)
+/* add a vertex to a path. Runs of invisible vertices are replaced by the
+ * crossings of segments with the culling region, and separate subpaths. */
+static void _plotincPathAddVertex(_plotincPath *path, double x, double y)
 {
-  int zero;
+  double dx, dy, t0, t1;
+  int code;
 
-  cairo_set_source_rgb( cairo, 0, 0, 0 ); /* black */
-  /* border */
-  cairo_set_line_width( cairo, PLOTINC_BORDER_LINEWIDTH );
-  cairo_rectangle( cairo, frame->plot_ox, frame->plot_oy, frame->plot_width, frame->plot_height );
-  /* x-axis */
-  cairo_set_line_width( cairo, PLOTINC_AXIS_LINEWIDTH );
-  if( _plotincAxisZeroIsIncluded( &frame->yaxis ) ){
-    zero = plotincFrameYCoord( frame, 0 );
-    cairo_move_to( cairo, frame->plot_ox, zero );
-    cairo_rel_line_to( cairo, frame->plot_width, 0 );
-  }
-  /* y-axis */
-  if( _plotincAxisZeroIsIncluded( &frame->xaxis ) ){
-    zero = plotincFrameXCoord( frame, 0 );
-    cairo_move_to( cairo, zero, frame->plot_oy );
-    cairo_rel_line_to( cairo, 0, frame->plot_height );
+  code = _plotincPathOutCode( path, x, y );
+#ifdef PLOTINC_PROFILE
+  if( code != 0 ) path->cull_num++; /* invisible, even if crossings are emitted instead */
+#endif
+  if( !path->flag_prev ){
+    path->flag_prev = true;
+    if( code == 0 ) _plotincPathDecimate( path, x, y );
+  } else
+  if( ( path->code_prev | code ) == 0 )
+    _plotincPathDecimate( path, x, y );
+  else
+  if( ( path->code_prev & code ) == 0 &&
+      _plotincPathClipSegment( path, path->x_prev, path->y_prev, x, y, &t0, &t1 ) ){
+    dx = x - path->x_prev;
+    dy = y - path->y_prev;
+    if( path->code_prev != 0 ){
+      _plotincPathBreak( path );
+      _plotincPathDecimate( path, path->x_prev + t0 * dx, path->y_prev + t0 * dy );
+    }
+    if( code != 0 )
+      _plotincPathDecimate( path, path->x_prev + t1 * dx, path->y_prev + t1 * dy );
+    else
+      _plotincPathDecimate( path, x, y );
   }
-  cairo_stroke( cairo );
+  path->x_prev = x;
+  path->y_prev = y;
+  path->code_prev = code;
 }
 
-static void _plotincFrameDrawXTicsOne(const plotincFrame *frame, cairo_t *cairo, int xtics, int y, int dy)
+static void _plotincPathStroke(_plotincPath *path)
 {
-  cairo_move_to( cairo, xtics, frame->plot_oy + y );
-  cairo_rel_line_to( cairo, 0, dy );
-  cairo_stroke( cairo );
+  _plotincPathFlushColumn( path );
+  if( path->tolerance > 0 ){
+    _plotincPathFlushChunk( path, true );
+    free( path->xbuf );
+    path->xbuf = NULL;
+    path->tolerance = 0;
+  }
+  cairo_stroke( path->cairo );
+  path->flag_open = false;
+#ifdef PLOTINC_PROFILE
+  PLOTINC_PROFILE_COUNT( emit_num, path->emit_num );
+  PLOTINC_PROFILE_COUNT( cull_num, path->cull_num );
+  PLOTINC_PROFILE_COUNT( decimate_num, path->decimate_num );
+  PLOTINC_PROFILE_COUNT( simplify_num, path->simplify_num );
+  path->emit_num = path->cull_num = path->decimate_num = path->simplify_num = 0;
+#endif
 }
-static void _plotincFrameDrawBottomXTicsOne(const plotincFrame *frame, cairo_t *cairo, int xtics)
+
+/* series */
+
+static plotincSeries *_plotincSeriesAlloc(int capacity)
 {
-  cairo_set_line_width( cairo, PLOTINC_TICS_LINEWIDTH );
-  _plotincFrameDrawXTicsOne( frame, cairo, xtics, frame->plot_height, -PLOTINC_TICSLENGTH );
+  plotincSeries *series;
+
+  if( !( series = malloc( sizeof(plotincSeries) ) ) ){
+    fprintf( stderr, "cannot allocate memory for a new series.\n" );
+    return NULL;
+  }
+  series->xbuf = malloc( sizeof(double)*capacity );
+  series->ybuf = malloc( sizeof(double)*capacity );
+  if( !series->xbuf || !series->ybuf ){
+    fprintf( stderr, "cannot allocate ring buffer of a series.\n" );
+    free( series->xbuf );
+    free( series->ybuf );
+    free( series );
+    return NULL;
+  }
+  series->capacity = capacity;
+  series->num = 0;
+  plotincSeriesClear( series );
+  plotincSeriesSetColor( series, 0, 0, 0 );
+  plotincSeriesSetLineWidth( series, PLOTINC_SERIES_LINEWIDTH );
+  series->next = NULL;
+  return series;
 }
-static void _plotincFrameDrawTopXTicsOne(const plotincFrame *frame, cairo_t *cairo, int xtics)
+
+static void _plotincSeriesFree(plotincSeries *series)
 {
-  cairo_set_line_width( cairo, PLOTINC_TICS_LINEWIDTH );
-  _plotincFrameDrawXTicsOne( frame, cairo, xtics, 0, PLOTINC_TICSLENGTH );
+  free( series->xbuf );
+  free( series->ybuf );
+  free( series );
 }
-static void _plotincFrameDrawXTicsVal(const plotincFrame *frame, cairo_t *cairo, double val, int xtics)
-{
-  cairo_text_extents_t te;
-  char str[BUFSIZ];
 
-  _plotincFrameRecallFont( frame, cairo );
-  sprintf( str, "%g", val );
-  cairo_text_extents( cairo, str, &te );
-  cairo_move_to( cairo, xtics - te.width / 2, frame->plot_oy + frame->plot_height + frame->baseline_skip );
-  cairo_show_text( cairo, str );
-}
-static void _plotincFrameDrawXTics(const plotincFrame *frame, cairo_t *cairo, double val, int tics)
+/* set color of a series. */
+void plotincSeriesSetColor(plotincSeries *series, double r, double g, double b)
 {
-  _plotincFrameDrawTopXTicsOne( frame, cairo, tics );
-  _plotincFrameDrawBottomXTicsOne( frame, cairo, tics );
-  _plotincFrameDrawXTicsVal( frame, cairo, val, tics );
+  series->r = r;
+  series->g = g;
+  series->b = b;
 }
 
-static void _plotincFrameDrawYTicsOne(const plotincFrame *frame, cairo_t *cairo, int ytics, int x, int dx)
+/* set line width of a series. */
+void plotincSeriesSetLineWidth(plotincSeries *series, double width)
 {
-  cairo_move_to( cairo, frame->plot_ox + x, ytics );
-  cairo_rel_line_to( cairo, dx, 0 );
-  cairo_stroke( cairo );
+  series->line_width = width;
 }
-static void _plotincFrameDrawLeftYTicsOne(const plotincFrame *frame, cairo_t *cairo, int ytics)
+
+/* clear all samples of a series. */
+void plotincSeriesClear(plotincSeries *series)
 {
-  cairo_set_line_width( cairo, PLOTINC_TICS_LINEWIDTH );
-  _plotincFrameDrawYTicsOne( frame, cairo, ytics, 0, PLOTINC_TICSLENGTH );
+  series->flag_evicted = series->num > 0;
+  series->head = series->num = series->fresh = 0;
 }
-static void _plotincFrameDrawRightYTicsOne(const plotincFrame *frame, cairo_t *cairo, int ytics)
+
+/* append a sample to a series, which overwrites the oldest one when the buffer is full. */
+void plotincSeriesAppend(plotincSeries *series, double x, double y)
 {
-  cairo_set_line_width( cairo, PLOTINC_TICS_LINEWIDTH );
-  _plotincFrameDrawYTicsOne( frame, cairo, ytics, frame->plot_width, -PLOTINC_TICSLENGTH );
+  int i;
+
+  if( series->num < series->capacity )
+    i = ( series->head + series->num++ ) % series->capacity;
+  else{
+    i = series->head;
+    series->head = ( series->head + 1 ) % series->capacity;
+    series->flag_evicted = true;
+  }
+  series->xbuf[i] = x;
+  series->ybuf[i] = y;
+  if( series->fresh < series->capacity ) series->fresh++;
 }
-static void _plotincFrameDrawYTicsVal(const plotincFrame *frame, cairo_t *cairo, double val, int ytics)
+
+/* append samples to a series. */
+void plotincSeriesAppendArray(plotincSeries *series, const double xdata[], const double ydata[], int size)
 {
-  cairo_text_extents_t te;
-  char str[BUFSIZ];
+  int i;
 
-  _plotincFrameRecallFont( frame, cairo );
-  sprintf( str, "%g", val );
-  cairo_text_extents( cairo, str, &te );
-  cairo_move_to( cairo, frame->plot_ox - te.width - PLOTINC_BASELINE_MARGIN, ytics + te.height/2 );
-  cairo_show_text( cairo, str );
+  for( i=0; i<size; i++ )
+    plotincSeriesAppend( series, xdata[i], ydata[i] );
 }
-static void _plotincFrameDrawYTics(const plotincFrame *frame, cairo_t *cairo, double val, int tics)
+
+/* i-th oldest sample of a series. */
+static int _plotincSeriesIndex(const plotincSeries *series, int i)
 {
-  _plotincFrameDrawLeftYTicsOne( frame, cairo, tics );
-  _plotincFrameDrawYTicsVal( frame, cairo, val, tics );
+  return ( series->head + i ) % series->capacity;
 }
 
-static void _plotincFrameDrawY2TicsVal(const plotincFrame *frame, cairo_t *cairo, double val, int ytics)
+/* SIMD */
+
+typedef enum{
+  PLOTINC_SIMD_NONE = 0,
+  PLOTINC_SIMD_SSE2,
+  PLOTINC_SIMD_AVX2,
+} _plotincSIMD;
+
+/* the widest instruction set available on the running processor. */
+static _plotincSIMD _plotincSIMDLevel(void)
 {
-  cairo_text_extents_t te;
-  char str[BUFSIZ];
+  static int level = -1;
 
-  _plotincFrameRecallFont( frame, cairo );
-  sprintf( str, "%g", val );
-  cairo_text_extents( cairo, str, &te );
-  cairo_move_to( cairo, frame->plot_ox +frame->plot_width + PLOTINC_BASELINE_MARGIN, ytics + te.height/2 );
-  cairo_show_text( cairo, str );
+  if( level < 0 ){
+#ifdef PLOTINC_SIMD_X86
+    __builtin_cpu_init();
+    level = __builtin_cpu_supports( "avx2" ) ? PLOTINC_SIMD_AVX2 : PLOTINC_SIMD_SSE2;
+#else
+    level = PLOTINC_SIMD_NONE;
+#endif
+  }
+  return level;
 }
-static void _plotincFrameDrawY2Tics(const plotincFrame *frame, cairo_t *cairo, double val, int tics)
+
+/* transform */
+
+/* The device coordinate is computed as offset + scale * value in this order on
+ * every path, so that scalar and vectorized transforms agree bit by bit.
+ * Integer coordinates are truncated toward zero after being clamped within
+ * PLOTINC_COORD_LIMIT; NaN is mapped to the lower limit. */
+
+static inline double _plotincTransformApply(const plotincTransform *transform, double val)
 {
-  _plotincFrameDrawRightYTicsOne( frame, cairo, tics );
-  _plotincFrameDrawY2TicsVal( frame, cairo, val, tics );
+  return transform->offset + transform->scale * val;
 }
 
-/* draw x-tics of a frame. */
-void plotincFrameDrawXTics(const plotincFrame *frame, cairo_t *cairo)
+static inline int _plotincTransformApplyInt(const plotincTransform *transform, double val)
 {
-  double tics_width, val;
-  int i, tics;
+  double coord;
 
-  cairo_set_source_rgb( cairo, 0, 0, 0 ); /* black */
-  tics_width = _plotincAxisTicsWidth( &frame->xaxis );
-  if( frame->xaxis.range_max > 0 && frame->xaxis.range_min < 0 ){
-    for( i=0; ( tics = plotincFrameXCoord( frame, ( val =-i * tics_width ) ) ) >= frame->plot_ox; i++ )
-      _plotincFrameDrawXTics( frame, cairo, val, tics );
-    for( i=1; ( tics = plotincFrameXCoord( frame, ( val = i * tics_width ) ) ) <= frame->plot_ox + frame->plot_width; i++ )
-      _plotincFrameDrawXTics( frame, cairo, val, tics );
-  } else{
-    for( i=0; ; i++ ){
-      tics = plotincFrameXCoord( frame, ( val = _plotincAxisTicsVal( &frame->xaxis, tics_width, i ) ) );
-      if( tics >= frame->plot_ox && tics <= frame->plot_ox + frame->plot_width )
-        _plotincFrameDrawXTics( frame, cairo, val, tics );
-      if( i > frame->xaxis.tics_num ) break;
-    }
-  }
+  coord = _plotincTransformApply( transform, val );
+  if( !( coord >= -PLOTINC_COORD_LIMIT ) ) return -PLOTINC_COORD_LIMIT;
+  if( coord > PLOTINC_COORD_LIMIT ) return PLOTINC_COORD_LIMIT;
+  return coord;
 }
 
-/* draw y-tics of a frame. */
-void plotincFrameDrawYTics(const plotincFrame *frame, cairo_t *cairo)
+#ifdef PLOTINC_SIMD_X86
+static void _plotincTransformDoubleArraySSE2(const plotincTransform *transform, const double src[], double dst[], int size)
 {
-  double tics_width, val;
-  int i, tics;
+  __m128d s, o;
+  int i;
 
-  cairo_set_source_rgb( cairo, 0, 0, 0 ); /* black */
-  tics_width = _plotincAxisTicsWidth( &frame->yaxis );
-  if( frame->yaxis.range_max > 0 && frame->yaxis.range_min < 0 ){
-    for( i=0; ( tics = plotincFrameYCoord( frame, ( val =-i * tics_width ) ) ) <= frame->plot_oy + frame->plot_height; i++ )
-      _plotincFrameDrawYTics( frame, cairo, val, tics );
-    for( i=1; ( tics = plotincFrameYCoord( frame, ( val = i * tics_width ) ) ) >= frame->plot_oy; i++ )
-      _plotincFrameDrawYTics( frame, cairo, val, tics );
-  } else{
-    for( i=0; ; i++ ){
-      tics = plotincFrameYCoord( frame, ( val = _plotincAxisTicsVal( &frame->yaxis, tics_width, i ) ) );
-      if( tics >= frame->plot_oy && tics <= frame->plot_oy + frame->plot_height )
-        _plotincFrameDrawYTics( frame, cairo, val, tics );
-      if( i > frame->yaxis.tics_num ) break;
-    }
-  }
+  s = _mm_set1_pd( transform->scale );
+  o = _mm_set1_pd( transform->offset );
+  for( i=0; i+2<=size; i+=2 )
+    _mm_storeu_pd( dst+i, _mm_add_pd( o, _mm_mul_pd( s, _mm_loadu_pd( src+i ) ) ) );
+  for( ; i<size; i++ ) dst[i] = _plotincTransformApply( transform, src[i] );
 }
 
-/* draw y2-tics of a frame. */
-void plotincFrameDrawY2Tics(const plotincFrame *frame, cairo_t *cairo)
+static void _plotincTransformFloatArraySSE2(const plotincTransform *transform, const float src[], double dst[], int size)
+{
+  __m128d s, o;
+  int i;
+
+  s = _mm_set1_pd( transform->scale );
+  o = _mm_set1_pd( transform->offset );
+  for( i=0; i+2<=size; i+=2 )
+    _mm_storeu_pd( dst+i, _mm_add_pd( o, _mm_mul_pd( s, _mm_cvtps_pd( _mm_castsi128_ps( _mm_loadl_epi64( (const __m128i *)( src+i ) ) ) ) ) ) );
+  for( ; i<size; i++ ) dst[i] = _plotincTransformApply( transform, src[i] );
+}
+
+static inline __m128i _plotincTransformIntSSE2(__m128d s, __m128d o, __m128d v)
+{
+  v = _mm_add_pd( o, _mm_mul_pd( s, v ) );
+  v = _mm_max_pd( v, _mm_set1_pd( -PLOTINC_COORD_LIMIT ) ); /* NaN goes to the lower limit */
+  v = _mm_min_pd( v, _mm_set1_pd( PLOTINC_COORD_LIMIT ) );
+  return _mm_cvttpd_epi32( v );
+}
+
+static void _plotincTransformDoubleArrayToIntSSE2(const plotincTransform *transform, const double src[], int dst[], int size)
+{
+  __m128d s, o;
+  int i;
+
+  s = _mm_set1_pd( transform->scale );
+  o = _mm_set1_pd( transform->offset );
+  for( i=0; i+2<=size; i+=2 )
+    _mm_storel_epi64( (__m128i *)( dst+i ), _plotincTransformIntSSE2( s, o, _mm_loadu_pd( src+i ) ) );
+  for( ; i<size; i++ ) dst[i] = _plotincTransformApplyInt( transform, src[i] );
+}
+
+static void _plotincTransformFloatArrayToIntSSE2(const plotincTransform *transform, const float src[], int dst[], int size)
+{
+  __m128d s, o;
+  int i;
+
+  s = _mm_set1_pd( transform->scale );
+  o = _mm_set1_pd( transform->offset );
+  for( i=0; i+2<=size; i+=2 )
+    _mm_storel_epi64( (__m128i *)( dst+i ), _plotincTransformIntSSE2( s, o,
+      _mm_cvtps_pd( _mm_castsi128_ps( _mm_loadl_epi64( (const __m128i *)( src+i ) ) ) ) ) );
+  for( ; i<size; i++ ) dst[i] = _plotincTransformApplyInt( transform, src[i] );
+}
+
+__attribute__((target("avx2")))
+static void _plotincTransformDoubleArrayAVX2(const plotincTransform *transform, const double src[], double dst[], int size)
+{
+  __m256d s, o;
+  int i;
+
+  s = _mm256_set1_pd( transform->scale );
+  o = _mm256_set1_pd( transform->offset );
+  for( i=0; i+4<=size; i+=4 )
+    _mm256_storeu_pd( dst+i, _mm256_add_pd( o, _mm256_mul_pd( s, _mm256_loadu_pd( src+i ) ) ) );
+  for( ; i<size; i++ ) dst[i] = _plotincTransformApply( transform, src[i] );
+}
+
+__attribute__((target("avx2")))
+static void _plotincTransformFloatArrayAVX2(const plotincTransform *transform, const float src[], double dst[], int size)
+{
+  __m256d s, o;
+  int i;
+
+  s = _mm256_set1_pd( transform->scale );
+  o = _mm256_set1_pd( transform->offset );
+  for( i=0; i+4<=size; i+=4 )
+    _mm256_storeu_pd( dst+i, _mm256_add_pd( o, _mm256_mul_pd( s, _mm256_cvtps_pd( _mm_loadu_ps( src+i ) ) ) ) );
+  for( ; i<size; i++ ) dst[i] = _plotincTransformApply( transform, src[i] );
+}
+
+__attribute__((target("avx2")))
+static inline __m128i _plotincTransformIntAVX2(__m256d s, __m256d o, __m256d v)
+{
+  v = _mm256_add_pd( o, _mm256_mul_pd( s, v ) );
+  v = _mm256_max_pd( v, _mm256_set1_pd( -PLOTINC_COORD_LIMIT ) ); /* NaN goes to the lower limit */
+  v = _mm256_min_pd( v, _mm256_set1_pd( PLOTINC_COORD_LIMIT ) );
+  return _mm256_cvttpd_epi32( v );
+}
+
+__attribute__((target("avx2")))
+static void _plotincTransformDoubleArrayToIntAVX2(const plotincTransform *transform, const double src[], int dst[], int size)
+{
+  __m256d s, o;
+  int i;
+
+  s = _mm256_set1_pd( transform->scale );
+  o = _mm256_set1_pd( transform->offset );
+  for( i=0; i+4<=size; i+=4 )
+    _mm_storeu_si128( (__m128i *)( dst+i ), _plotincTransformIntAVX2( s, o, _mm256_loadu_pd( src+i ) ) );
+  for( ; i<size; i++ ) dst[i] = _plotincTransformApplyInt( transform, src[i] );
+}
+
+__attribute__((target("avx2")))
+static void _plotincTransformFloatArrayToIntAVX2(const plotincTransform *transform, const float src[], int dst[], int size)
+{
+  __m256d s, o;
+  int i;
+
+  s = _mm256_set1_pd( transform->scale );
+  o = _mm256_set1_pd( transform->offset );
+  for( i=0; i+4<=size; i+=4 )
+    _mm_storeu_si128( (__m128i *)( dst+i ), _plotincTransformIntAVX2( s, o, _mm256_cvtps_pd( _mm_loadu_ps( src+i ) ) ) );
+  for( ; i<size; i++ ) dst[i] = _plotincTransformApplyInt( transform, src[i] );
+}
+#endif /* PLOTINC_SIMD_X86 */
+
+/* transform an array of double-precision values to device coordinates. */
+void plotincTransformDoubleArray(const plotincTransform *transform, const double src[], double dst[], int size)
+{
+  int i;
+
+  switch( _plotincSIMDLevel() ){
+#ifdef PLOTINC_SIMD_X86
+  case PLOTINC_SIMD_AVX2: _plotincTransformDoubleArrayAVX2( transform, src, dst, size ); return;
+  case PLOTINC_SIMD_SSE2: _plotincTransformDoubleArraySSE2( transform, src, dst, size ); return;
+#endif
+  default:
+    for( i=0; i<size; i++ ) dst[i] = _plotincTransformApply( transform, src[i] );
+  }
+}
+
+/* transform an array of single-precision values to device coordinates. */
+void plotincTransformFloatArray(const plotincTransform *transform, const float src[], double dst[], int size)
+{
+  int i;
+
+  switch( _plotincSIMDLevel() ){
+#ifdef PLOTINC_SIMD_X86
+  case PLOTINC_SIMD_AVX2: _plotincTransformFloatArrayAVX2( transform, src, dst, size ); return;
+  case PLOTINC_SIMD_SSE2: _plotincTransformFloatArraySSE2( transform, src, dst, size ); return;
+#endif
+  default:
+    for( i=0; i<size; i++ ) dst[i] = _plotincTransformApply( transform, src[i] );
+  }
+}
+
+/* transform an array of double-precision values to integer device coordinates. */
+void plotincTransformDoubleArrayToInt(const plotincTransform *transform, const double src[], int dst[], int size)
+{
+  int i;
+
+  switch( _plotincSIMDLevel() ){
+#ifdef PLOTINC_SIMD_X86
+  case PLOTINC_SIMD_AVX2: _plotincTransformDoubleArrayToIntAVX2( transform, src, dst, size ); return;
+  case PLOTINC_SIMD_SSE2: _plotincTransformDoubleArrayToIntSSE2( transform, src, dst, size ); return;
+#endif
+  default:
+    for( i=0; i<size; i++ ) dst[i] = _plotincTransformApplyInt( transform, src[i] );
+  }
+}
+
+/* transform an array of single-precision values to integer device coordinates. */
+void plotincTransformFloatArrayToInt(const plotincTransform *transform, const float src[], int dst[], int size)
+{
+  int i;
+
+  switch( _plotincSIMDLevel() ){
+#ifdef PLOTINC_SIMD_X86
+  case PLOTINC_SIMD_AVX2: _plotincTransformFloatArrayToIntAVX2( transform, src, dst, size ); return;
+  case PLOTINC_SIMD_SSE2: _plotincTransformFloatArrayToIntSSE2( transform, src, dst, size ); return;
+#endif
+  default:
+    for( i=0; i<size; i++ ) dst[i] = _plotincTransformApplyInt( transform, src[i] );
+  }
+}
+
+/* minimum and maximum */
+
+/* NaNs are ignored; MINPD and MAXPD return the second operand if either is NaN,
+ * which is always the accumulator. An array without numbers has +HUGE_VAL for
+ * the minimum and -HUGE_VAL for the maximum. */
+
+#ifdef PLOTINC_SIMD_X86
+static void _plotincMinMaxSSE2(const double data[], int size, double *min, double *max)
+{
+  __m128d min0, min1, max0, max1, v;
+  double m[2];
+  int i;
+
+  min0 = min1 = _mm_set1_pd( HUGE_VAL );
+  max0 = max1 = _mm_set1_pd(-HUGE_VAL );
+  for( i=0; i+4<=size; i+=4 ){
+    v = _mm_loadu_pd( data+i );
+    min0 = _mm_min_pd( v, min0 );
+    max0 = _mm_max_pd( v, max0 );
+    v = _mm_loadu_pd( data+i+2 );
+    min1 = _mm_min_pd( v, min1 );
+    max1 = _mm_max_pd( v, max1 );
+  }
+  _mm_storeu_pd( m, _mm_min_pd( min0, min1 ) );
+  *min = m[0] < m[1] ? m[0] : m[1];
+  _mm_storeu_pd( m, _mm_max_pd( max0, max1 ) );
+  *max = m[0] > m[1] ? m[0] : m[1];
+  for( ; i<size; i++ ){
+    if( data[i] < *min ) *min = data[i];
+    if( data[i] > *max ) *max = data[i];
+  }
+}
+
+__attribute__((target("avx2")))
+static void _plotincMinMaxAVX2(const double data[], int size, double *min, double *max)
+{
+  __m256d min0, min1, max0, max1, v;
+  double m[4];
+  int i, j;
+
+  min0 = min1 = _mm256_set1_pd( HUGE_VAL );
+  max0 = max1 = _mm256_set1_pd(-HUGE_VAL );
+  for( i=0; i+8<=size; i+=8 ){
+    v = _mm256_loadu_pd( data+i );
+    min0 = _mm256_min_pd( v, min0 );
+    max0 = _mm256_max_pd( v, max0 );
+    v = _mm256_loadu_pd( data+i+4 );
+    min1 = _mm256_min_pd( v, min1 );
+    max1 = _mm256_max_pd( v, max1 );
+  }
+  _mm256_storeu_pd( m, _mm256_min_pd( min0, min1 ) );
+  for( *min=m[0], j=1; j<4; j++ ) if( m[j] < *min ) *min = m[j];
+  _mm256_storeu_pd( m, _mm256_max_pd( max0, max1 ) );
+  for( *max=m[0], j=1; j<4; j++ ) if( m[j] > *max ) *max = m[j];
+  for( ; i<size; i++ ){
+    if( data[i] < *min ) *min = data[i];
+    if( data[i] > *max ) *max = data[i];
+  }
+}
+#endif /* PLOTINC_SIMD_X86 */
+
+/* find the minimum and maximum of an array except NaNs. */
+static void _plotincMinMax(const double data[], int size, double *min, double *max)
+{
+  int i;
+
+  switch( _plotincSIMDLevel() ){
+#ifdef PLOTINC_SIMD_X86
+  case PLOTINC_SIMD_AVX2: _plotincMinMaxAVX2( data, size, min, max ); return;
+  case PLOTINC_SIMD_SSE2: _plotincMinMaxSSE2( data, size, min, max ); return;
+#endif
+  default:
+    *min = HUGE_VAL;
+    *max =-HUGE_VAL;
+    for( i=0; i<size; i++ ){
+      if( data[i] < *min ) *min = data[i];
+      if( data[i] > *max ) *max = data[i];
+    }
+  }
+}
+
+/* column */
+
+/* byte size of an element of a data type. */
+size_t plotincDataTypeSize(plotincDataType type)
+{
+  switch( type ){
+  case PLOTINC_DATA_FLOAT:  return sizeof(float);
+  case PLOTINC_DATA_INT16:  return sizeof(int16_t);
+  case PLOTINC_DATA_INT32:  return sizeof(int32_t);
+  case PLOTINC_DATA_INT64:  return sizeof(int64_t);
+  case PLOTINC_DATA_UINT8:  return sizeof(uint8_t);
+  case PLOTINC_DATA_UINT16: return sizeof(uint16_t);
+  default:                  return sizeof(double);
+  }
+}
+
+/* assign an array of elements of a type placed at a byte stride to a column.
+ * stride is the element size if zero. */
+void plotincColumnAssign(plotincColumn *column, plotincDataType type, const void *data, size_t stride, int size)
+{
+  column->data = data;
+  column->type = type;
+  column->stride = stride > 0 ? stride : plotincDataTypeSize( type );
+  column->size = size;
+}
+
+/* element of a type at a possibly unaligned address */
+#define PLOTINC_COLUMN_ELEM(type,ptr) ( { type _v; memcpy( &_v, ptr, sizeof(type) ); _v; } )
+
+/* value of an element of a data type at an address. */
+static inline double _plotincDataValue(plotincDataType type, const char *ptr)
+{
+  switch( type ){
+  case PLOTINC_DATA_FLOAT:  return PLOTINC_COLUMN_ELEM( float, ptr );
+  case PLOTINC_DATA_INT16:  return PLOTINC_COLUMN_ELEM( int16_t, ptr );
+  case PLOTINC_DATA_INT32:  return PLOTINC_COLUMN_ELEM( int32_t, ptr );
+  case PLOTINC_DATA_INT64:  return PLOTINC_COLUMN_ELEM( int64_t, ptr );
+  case PLOTINC_DATA_UINT8:  return PLOTINC_COLUMN_ELEM( uint8_t, ptr );
+  case PLOTINC_DATA_UINT16: return PLOTINC_COLUMN_ELEM( uint16_t, ptr );
+  default:                  return PLOTINC_COLUMN_ELEM( double, ptr );
+  }
+}
+
+/* value of the i-th element of a column. */
+static inline double _plotincColumnValue(const plotincColumn *column, int i)
+{
+  return _plotincDataValue( column->type, (const char *)column->data + (size_t)i * column->stride );
+}
+
+/* n elements of a column from the i-th as double-precision values.
+ * Contiguous and aligned double-precision values are referred in place,
+ * while the others are converted into buf. */
+static const double *_plotincColumnChunk(const plotincColumn *column, int i, int n, double buf[])
+{
+  const char *ptr;
+  int j;
+
+  ptr = (const char *)column->data + (size_t)i * column->stride;
+  if( column->type == PLOTINC_DATA_DOUBLE && column->stride == sizeof(double) &&
+      (uintptr_t)ptr % sizeof(double) == 0 )
+    return (const double *)ptr;
+  switch( column->type ){
+  case PLOTINC_DATA_FLOAT:
+    for( j=0; j<n; j++, ptr+=column->stride ) buf[j] = PLOTINC_COLUMN_ELEM( float, ptr );
+    break;
+  case PLOTINC_DATA_INT16:
+    for( j=0; j<n; j++, ptr+=column->stride ) buf[j] = PLOTINC_COLUMN_ELEM( int16_t, ptr );
+    break;
+  case PLOTINC_DATA_INT32:
+    for( j=0; j<n; j++, ptr+=column->stride ) buf[j] = PLOTINC_COLUMN_ELEM( int32_t, ptr );
+    break;
+  case PLOTINC_DATA_INT64:
+    for( j=0; j<n; j++, ptr+=column->stride ) buf[j] = PLOTINC_COLUMN_ELEM( int64_t, ptr );
+    break;
+  case PLOTINC_DATA_UINT8:
+    for( j=0; j<n; j++, ptr+=column->stride ) buf[j] = PLOTINC_COLUMN_ELEM( uint8_t, ptr );
+    break;
+  case PLOTINC_DATA_UINT16:
+    for( j=0; j<n; j++, ptr+=column->stride ) buf[j] = PLOTINC_COLUMN_ELEM( uint16_t, ptr );
+    break;
+  default:
+    for( j=0; j<n; j++, ptr+=column->stride ) buf[j] = PLOTINC_COLUMN_ELEM( double, ptr );
+  }
+  return buf;
+}
+
+/* transform n elements of a column from the i-th to integer device coordinates.
+ * Conversion of elements is fused into the transform, and contiguous
+ * floating-point values are transformed by vectorized kernels. */
+static void _plotincColumnTransformToInt(const plotincTransform *transform, const plotincColumn *column, int i, int n, int dst[])
+{
+  const char *ptr;
+  int j;
+
+  ptr = (const char *)column->data + (size_t)i * column->stride;
+  switch( column->type ){
+  case PLOTINC_DATA_FLOAT:
+    if( column->stride == sizeof(float) && (uintptr_t)ptr % sizeof(float) == 0 ){
+      plotincTransformFloatArrayToInt( transform, (const float *)ptr, dst, n );
+      break;
+    }
+    for( j=0; j<n; j++, ptr+=column->stride )
+      dst[j] = _plotincTransformApplyInt( transform, PLOTINC_COLUMN_ELEM( float, ptr ) );
+    break;
+  case PLOTINC_DATA_INT16:
+    for( j=0; j<n; j++, ptr+=column->stride )
+      dst[j] = _plotincTransformApplyInt( transform, PLOTINC_COLUMN_ELEM( int16_t, ptr ) );
+    break;
+  case PLOTINC_DATA_INT32:
+    for( j=0; j<n; j++, ptr+=column->stride )
+      dst[j] = _plotincTransformApplyInt( transform, PLOTINC_COLUMN_ELEM( int32_t, ptr ) );
+    break;
+  case PLOTINC_DATA_INT64:
+    for( j=0; j<n; j++, ptr+=column->stride )
+      dst[j] = _plotincTransformApplyInt( transform, PLOTINC_COLUMN_ELEM( int64_t, ptr ) );
+    break;
+  case PLOTINC_DATA_UINT8:
+    for( j=0; j<n; j++, ptr+=column->stride )
+      dst[j] = _plotincTransformApplyInt( transform, PLOTINC_COLUMN_ELEM( uint8_t, ptr ) );
+    break;
+  case PLOTINC_DATA_UINT16:
+    for( j=0; j<n; j++, ptr+=column->stride )
+      dst[j] = _plotincTransformApplyInt( transform, PLOTINC_COLUMN_ELEM( uint16_t, ptr ) );
+    break;
+  default:
+    if( column->stride == sizeof(double) && (uintptr_t)ptr % sizeof(double) == 0 ){
+      plotincTransformDoubleArrayToInt( transform, (const double *)ptr, dst, n );
+      break;
+    }
+    for( j=0; j<n; j++, ptr+=column->stride )
+      dst[j] = _plotincTransformApplyInt( transform, PLOTINC_COLUMN_ELEM( double, ptr ) );
+  }
+}
+
+/* data source */
+
+/* open a binary file as a data source mapped on memory.
+ * Pages are read on demand, so that files larger than the physical memory
+ * can be plotted without copying. */
+bool plotincDataSourceOpen(plotincDataSource *source, const char *filename)
+{
+  struct stat st;
+
+  if( ( source->fd = open( filename, O_RDONLY ) ) < 0 ){
+    fprintf( stderr, "cannot open %s.\n", filename );
+    return false;
+  }
+  if( fstat( source->fd, &st ) < 0 ){
+    fprintf( stderr, "cannot get status of %s.\n", filename );
+    goto FAILURE;
+  }
+  if( st.st_size <= 0 ){
+    fprintf( stderr, "cannot map empty file %s.\n", filename );
+    goto FAILURE;
+  }
+  source->length = st.st_size;
+  if( ( source->map = mmap( NULL, source->length, PROT_READ, MAP_SHARED, source->fd, 0 ) ) == MAP_FAILED ){
+    fprintf( stderr, "cannot map %s on memory.\n", filename );
+    goto FAILURE;
+  }
+  /* data are mostly scanned from the head to the tail */
+  madvise( source->map, source->length, MADV_SEQUENTIAL );
+  return true;
+ FAILURE:
+  close( source->fd );
+  source->fd = -1;
+  source->map = NULL;
+  source->length = 0;
+  return false;
+}
+
+/* close a data source. */
+void plotincDataSourceClose(plotincDataSource *source)
+{
+  if( source->map ) munmap( source->map, source->length );
+  if( source->fd >= 0 ) close( source->fd );
+  source->fd = -1;
+  source->map = NULL;
+  source->length = 0;
+}
+
+/* assign a column of elements of a type to a data source, which begins at
+ * offset and steps by stride in bytes. stride is the element size if zero. */
+bool plotincDataSourceColumn(const plotincDataSource *source, plotincColumn *column, plotincDataType type, size_t offset, size_t stride)
+{
+  size_t size;
+
+  if( stride == 0 ) stride = plotincDataTypeSize( type );
+  if( !source->map || offset + plotincDataTypeSize( type ) > source->length ){
+    fprintf( stderr, "column out of a data source.\n" );
+    return false;
+  }
+  size = ( source->length - offset - plotincDataTypeSize( type ) ) / stride + 1;
+  if( size > INT_MAX ){
+    fprintf( stderr, "too many elements in a column, truncated.\n" );
+    size = INT_MAX;
+  }
+  column->data = (const char *)source->map + offset;
+  column->type = type;
+  column->stride = stride;
+  column->size = size;
+  return true;
+}
+
+/* pyramid */
+
+/* initialize a pyramid of minima and maxima without data. */
+void plotincPyramidInit(plotincPyramid *pyramid)
+{
+  memset( pyramid, 0, sizeof(plotincPyramid) );
+  pyramid->thread_num = 1;
+}
+
+/* destroy a pyramid, where the referenced data are left. */
+void plotincPyramidDestroy(plotincPyramid *pyramid)
+{
+  int k;
+
+  for( k=0; k<PLOTINC_PYRAMID_MAXLEVEL; k++ ){
+    free( pyramid->level[k].min );
+    free( pyramid->level[k].max );
+  }
+  plotincPyramidInit( pyramid );
+}
+
+/* set number of threads to build a pyramid. */
+void plotincPyramidSetThreadNum(plotincPyramid *pyramid, int num)
+{
+  pyramid->thread_num = num > 0 ? num : 1;
+}
+
+/* blocks of a level of a pyramid to be rebuilt. */
+typedef struct{
+  plotincPyramid *pyramid;
+  int k;
+  int from;
+  int to;
+} _plotincPyramidJob;
+
+/* rebuild a range of blocks of a level from data or the lower level.
+ * NaNs are ignored, and a block of NaNs only has the minimum above the maximum. */
+static void _plotincPyramidBuild(void *arg, int i)
+{
+  _plotincPyramidJob *job = arg;
+  plotincPyramidLevel *level = &job->pyramid->level[job->k], *lower;
+  const plotincColumn *column = &job->pyramid->column;
+  double buf[1<<PLOTINC_PYRAMID_BLOCK_SHIFT];
+  const double *chunk;
+  double min, max;
+  int j, j_end, l, n;
+
+  j = job->from + i * PLOTINC_PYRAMID_BLOCKS_PER_JOB;
+  if( ( j_end = j + PLOTINC_PYRAMID_BLOCKS_PER_JOB ) > job->to ) j_end = job->to;
+  for( ; j<j_end; j++ ){
+    min = HUGE_VAL;
+    max =-HUGE_VAL;
+    if( job->k == 0 ){
+      l = j << PLOTINC_PYRAMID_BLOCK_SHIFT;
+      n = column->size - l < 1<<PLOTINC_PYRAMID_BLOCK_SHIFT ? column->size - l : 1<<PLOTINC_PYRAMID_BLOCK_SHIFT;
+      chunk = _plotincColumnChunk( column, l, n, buf );
+      _plotincMinMax( chunk, n, &min, &max );
+    } else{
+      lower = level - 1;
+      for( l=2*j; l<2*j+2 && l<lower->size; l++ ){
+        if( lower->min[l] < min ) min = lower->min[l];
+        if( lower->max[l] > max ) max = lower->max[l];
+      }
+    }
+    level->min[j] = min;
+    level->max[j] = max;
+  }
+}
+
+/* reserve blocks of a level of a pyramid. */
+static bool _plotincPyramidReserve(plotincPyramidLevel *level, int size)
+{
+  double *min, *max;
+  int capacity;
+
+  if( size <= level->capacity ) return true;
+  for( capacity=level->capacity>0?level->capacity:1; capacity<size; )
+    capacity = capacity > INT_MAX/2 ? size : capacity*2;
+  if( !( min = realloc( level->min, sizeof(double)*capacity ) ) ) return false;
+  level->min = min;
+  if( !( max = realloc( level->max, sizeof(double)*capacity ) ) ) return false;
+  level->max = max;
+  level->capacity = capacity;
+  return true;
+}
+
+/* extend a pyramid to data in a column, which are those built before
+ * followed by appended ones. Only blocks covering the appended data are built,
+ * in parallel. The column may be moved, while data built before must not change. */
+bool plotincPyramidExtendColumn(plotincPyramid *pyramid, const plotincColumn *column)
+{
+  _plotincPyramidJob job;
+  int size_prev, shift, k;
+
+  size_prev = pyramid->column.size;
+  if( column->size < size_prev ){
+    fprintf( stderr, "cannot shrink a pyramid.\n" );
+    return false;
+  }
+  pyramid->column = *column;
+  if( column->size == 0 ) return true;
+  job.pyramid = pyramid;
+  for( k=0; k<PLOTINC_PYRAMID_MAXLEVEL; k++ ){
+    shift = PLOTINC_PYRAMID_BLOCK_SHIFT + k;
+    job.k = k;
+    job.from = k < pyramid->level_num ? size_prev >> shift : 0;
+    job.to = (int)( ( (long)column->size + ( 1L<<shift ) - 1 ) >> shift );
+    if( !_plotincPyramidReserve( &pyramid->level[k], job.to ) ){
+      fprintf( stderr, "cannot allocate memory for a pyramid.\n" );
+      pyramid->column.size = size_prev;
+      return false;
+    }
+    pyramid->level[k].size = job.to;
+    _plotincParallel( pyramid->thread_num,
+      ( job.to - job.from + PLOTINC_PYRAMID_BLOCKS_PER_JOB - 1 ) / PLOTINC_PYRAMID_BLOCKS_PER_JOB,
+      _plotincPyramidBuild, &job );
+    if( job.to == 1 ) break;
+  }
+  pyramid->level_num = k < PLOTINC_PYRAMID_MAXLEVEL ? k + 1 : PLOTINC_PYRAMID_MAXLEVEL;
+  return true;
+}
+
+/* extend a pyramid to an array of double-precision data. */
+bool plotincPyramidExtend(plotincPyramid *pyramid, const double data[], int size)
+{
+  plotincColumn column;
+
+  plotincColumnAssign( &column, PLOTINC_DATA_DOUBLE, data, 0, size );
+  return plotincPyramidExtendColumn( pyramid, &column );
+}
+
+/* update the minimum and maximum by samples of a pyramid from index from to index to (exclusive). */
+static void _plotincPyramidScan(const plotincPyramid *pyramid, int from, int to, double *min, double *max)
+{
+  double buf[1<<PLOTINC_PYRAMID_BLOCK_SHIFT];
+  const double *chunk;
+  double cmin, cmax;
+  int n;
+
+  for( ; from<to; from+=n ){
+    n = to - from < 1<<PLOTINC_PYRAMID_BLOCK_SHIFT ? to - from : 1<<PLOTINC_PYRAMID_BLOCK_SHIFT;
+    chunk = _plotincColumnChunk( &pyramid->column, from, n, buf );
+    _plotincMinMax( chunk, n, &cmin, &cmax );
+    if( cmin < *min ) *min = cmin;
+    if( cmax > *max ) *max = cmax;
+  }
+}
+
+/* find the minimum and maximum of data from index from to index to (exclusive)
+ * through O(log(to-from)) blocks and samples of at most two partial blocks.
+ * false is returned if there is no number in the range. */
+bool plotincPyramidMinMax(const plotincPyramid *pyramid, int from, int to, double *min, double *max)
+{
+  int l, r, k;
+
+  if( from < 0 ) from = 0;
+  if( to > pyramid->column.size ) to = pyramid->column.size;
+  *min = HUGE_VAL;
+  *max =-HUGE_VAL;
+  /* whole blocks from l to r (exclusive) of the lowest level */
+  l = ( from + ( 1<<PLOTINC_PYRAMID_BLOCK_SHIFT ) - 1 ) >> PLOTINC_PYRAMID_BLOCK_SHIFT;
+  r = to >> PLOTINC_PYRAMID_BLOCK_SHIFT;
+  if( l >= r ){
+    _plotincPyramidScan( pyramid, from, to, min, max );
+    return *min <= *max;
+  }
+  _plotincPyramidScan( pyramid, from, l << PLOTINC_PYRAMID_BLOCK_SHIFT, min, max );
+  _plotincPyramidScan( pyramid, r << PLOTINC_PYRAMID_BLOCK_SHIFT, to, min, max );
+  /* climbing up the levels */
+  for( k=0; l<r && k<pyramid->level_num; k++, l>>=1, r>>=1 ){
+    if( l & 1 ){
+      if( pyramid->level[k].min[l] < *min ) *min = pyramid->level[k].min[l];
+      if( pyramid->level[k].max[l] > *max ) *max = pyramid->level[k].max[l];
+      l++;
+    }
+    if( r & 1 ){
+      r--;
+      if( pyramid->level[k].min[r] < *min ) *min = pyramid->level[k].min[r];
+      if( pyramid->level[k].max[r] > *max ) *max = pyramid->level[k].max[r];
+    }
+  }
+  return *min <= *max;
+}
+
+/* colormap */
+
+typedef struct{
+  double pos;
+  double r, g, b;
+} _plotincColormapKnot;
+
+static const _plotincColormapKnot _plotinc_colormap_gray[] = {
+  { 0.0, 0, 0, 0 }, { 1.0, 1, 1, 1 },
+  { -1, 0, 0, 0 },
+};
+static const _plotincColormapKnot _plotinc_colormap_hot[] = {
+  { 0.0, 0, 0, 0 }, { 0.375, 1, 0, 0 }, { 0.75, 1, 1, 0 }, { 1.0, 1, 1, 1 },
+  { -1, 0, 0, 0 },
+};
+static const _plotincColormapKnot _plotinc_colormap_jet[] = {
+  { 0.0, 0, 0, 0.5 }, { 0.125, 0, 0, 1 }, { 0.375, 0, 1, 1 }, { 0.625, 1, 1, 0 }, { 0.875, 1, 0, 0 }, { 1.0, 0.5, 0, 0 },
+  { -1, 0, 0, 0 },
+};
+static const _plotincColormapKnot _plotinc_colormap_viridis[] = {
+  { 0.0, 0.267, 0.005, 0.329 }, { 0.25, 0.229, 0.322, 0.546 }, { 0.5, 0.128, 0.567, 0.551 }, { 0.75, 0.369, 0.789, 0.383 }, { 1.0, 0.993, 0.906, 0.144 },
+  { -1, 0, 0, 0 },
+};
+
+/* opaque ARGB32 color at a position between 0 and 1 interpolated on knots. */
+static uint32_t _plotincColormapColor(const _plotincColormapKnot knot[], double pos)
+{
+  double t;
+  int i;
+
+  for( i=1; knot[i+1].pos >= 0 && knot[i].pos < pos; i++ );
+  t = ( pos - knot[i-1].pos ) / ( knot[i].pos - knot[i-1].pos );
+  if( t < 0 ) t = 0;
+  if( t > 1 ) t = 1;
+  return 0xff000000 |
+    (uint32_t)( ( knot[i-1].r + ( knot[i].r - knot[i-1].r ) * t ) * 255 + 0.5 ) << 16 |
+    (uint32_t)( ( knot[i-1].g + ( knot[i].g - knot[i-1].g ) * t ) * 255 + 0.5 ) << 8 |
+    (uint32_t)( ( knot[i-1].b + ( knot[i].b - knot[i-1].b ) * t ) * 255 + 0.5 );
+}
+
+/* initialize a colormap of a given size, which is the default if zero. */
+bool plotincColormapInit(plotincColormap *colormap, plotincColormapType type, int size)
+{
+  const _plotincColormapKnot *knot;
+  int i;
+
+  if( size <= 0 ) size = PLOTINC_COLORMAP_DEFAULT_SIZE;
+  if( size < 2 ) size = 2;
+  if( size > PLOTINC_COLORMAP_MAXSIZE ) size = PLOTINC_COLORMAP_MAXSIZE;
+  if( !( colormap->table = malloc( sizeof(uint32_t)*( size + 1 ) ) ) ){
+    fprintf( stderr, "cannot allocate memory for a colormap.\n" );
+    return false;
+  }
+  switch( type ){
+  case PLOTINC_COLORMAP_HOT:     knot = _plotinc_colormap_hot;     break;
+  case PLOTINC_COLORMAP_JET:     knot = _plotinc_colormap_jet;     break;
+  case PLOTINC_COLORMAP_VIRIDIS: knot = _plotinc_colormap_viridis; break;
+  default:                       knot = _plotinc_colormap_gray;
+  }
+  for( i=0; i<size; i++ )
+    colormap->table[i] = _plotincColormapColor( knot, (double)i / ( size - 1 ) );
+  colormap->table[size] = 0; /* transparent */
+  colormap->size = size;
+  colormap->min = 0;
+  colormap->max = 1;
+  return true;
+}
+
+/* destroy a colormap. */
+void plotincColormapDestroy(plotincColormap *colormap)
+{
+  free( colormap->table );
+  colormap->table = NULL;
+  colormap->size = 0;
+}
+
+/* set range of values mapped onto a colormap. */
+void plotincColormapSetRange(plotincColormap *colormap, double min, double max)
+{
+  colormap->min = min;
+  colormap->max = max;
+}
+
+/* The table index is computed as ( value - min ) * scale + 0.5 in this order
+ * and truncated after being clamped within the table on every path, while NaN
+ * is mapped to the transparent color next to the table. */
+
+static inline double _plotincColormapScale(const plotincColormap *colormap)
+{
+  return colormap->max > colormap->min ? ( colormap->size - 1 ) / ( colormap->max - colormap->min ) : 0;
+}
+
+static inline uint32_t _plotincColormapLookup(const plotincColormap *colormap, double scale, double val)
+{
+  double index;
+
+  if( isnan( val ) ) return colormap->table[colormap->size];
+  index = ( val - colormap->min ) * scale + 0.5;
+  if( !( index > 0 ) ) index = 0;
+  if( index > colormap->size - 1 ) index = colormap->size - 1;
+  return colormap->table[(int)index];
+}
+
+#ifdef PLOTINC_SIMD_X86
+static void _plotincColormapApplySSE2(const plotincColormap *colormap, const double src[], uint32_t dst[], int size)
+{
+  __m128d scale, min, half, zero, last, nan_index, v, nan;
+  int index[4];
+  int i;
+
+  scale = _mm_set1_pd( _plotincColormapScale( colormap ) );
+  min = _mm_set1_pd( colormap->min );
+  half = _mm_set1_pd( 0.5 );
+  zero = _mm_setzero_pd();
+  last = _mm_set1_pd( colormap->size - 1 );
+  nan_index = _mm_set1_pd( colormap->size );
+  for( i=0; i+2<=size; i+=2 ){
+    v = _mm_loadu_pd( src+i );
+    nan = _mm_cmpunord_pd( v, v );
+    v = _mm_add_pd( _mm_mul_pd( _mm_sub_pd( v, min ), scale ), half );
+    v = _mm_min_pd( _mm_max_pd( v, zero ), last );
+    v = _mm_or_pd( _mm_and_pd( nan, nan_index ), _mm_andnot_pd( nan, v ) );
+    _mm_storeu_si128( (__m128i *)index, _mm_cvttpd_epi32( v ) );
+    dst[i]   = colormap->table[index[0]];
+    dst[i+1] = colormap->table[index[1]];
+  }
+  for( ; i<size; i++ )
+    dst[i] = _plotincColormapLookup( colormap, _plotincColormapScale( colormap ), src[i] );
+}
+
+__attribute__((target("avx2")))
+static void _plotincColormapApplyAVX2(const plotincColormap *colormap, const double src[], uint32_t dst[], int size)
+{
+  __m256d scale, min, half, zero, last, nan_index, v, nan;
+  int i;
+
+  scale = _mm256_set1_pd( _plotincColormapScale( colormap ) );
+  min = _mm256_set1_pd( colormap->min );
+  half = _mm256_set1_pd( 0.5 );
+  zero = _mm256_setzero_pd();
+  last = _mm256_set1_pd( colormap->size - 1 );
+  nan_index = _mm256_set1_pd( colormap->size );
+  for( i=0; i+4<=size; i+=4 ){
+    v = _mm256_loadu_pd( src+i );
+    nan = _mm256_cmp_pd( v, v, _CMP_UNORD_Q );
+    v = _mm256_add_pd( _mm256_mul_pd( _mm256_sub_pd( v, min ), scale ), half );
+    v = _mm256_min_pd( _mm256_max_pd( v, zero ), last );
+    v = _mm256_blendv_pd( v, nan_index, nan );
+    _mm_storeu_si128( (__m128i *)( dst+i ),
+      _mm_i32gather_epi32( (const int *)colormap->table, _mm256_cvttpd_epi32( v ), 4 ) );
+  }
+  for( ; i<size; i++ )
+    dst[i] = _plotincColormapLookup( colormap, _plotincColormapScale( colormap ), src[i] );
+}
+#endif /* PLOTINC_SIMD_X86 */
+
+/* map an array of values to ARGB32 colors through a colormap. */
+void plotincColormapApply(const plotincColormap *colormap, const double src[], uint32_t dst[], int size)
+{
+  double scale;
+  int i;
+
+  switch( _plotincSIMDLevel() ){
+#ifdef PLOTINC_SIMD_X86
+  case PLOTINC_SIMD_AVX2: _plotincColormapApplyAVX2( colormap, src, dst, size ); return;
+  case PLOTINC_SIMD_SSE2: _plotincColormapApplySSE2( colormap, src, dst, size ); return;
+#endif
+  default:
+    scale = _plotincColormapScale( colormap );
+    for( i=0; i<size; i++ ) dst[i] = _plotincColormapLookup( colormap, scale, src[i] );
+  }
+}
+
+/* frame */
+
+/* release the resolved font of a frame, which also invalidates extents of tic values. */
+static void _plotincFrameReleaseFont(plotincFrame *frame)
+{
+  if( frame->scaled_font ) cairo_scaled_font_destroy( frame->scaled_font );
+  if( frame->font_face ) cairo_font_face_destroy( frame->font_face );
+  if( frame->font_options ) cairo_font_options_destroy( frame->font_options );
+  frame->scaled_font = NULL;
+  frame->font_face = NULL;
+  frame->font_options = NULL;
+  _plotincAxisClearTicsCache( &frame->xaxis );
+  _plotincAxisClearTicsCache( &frame->yaxis );
+  _plotincAxisClearTicsCache( &frame->y2axis );
+}
+
+/* invalidate the cached background layer of a frame. */
+static void _plotincFrameInvalidate(plotincFrame *frame)
+{
+  if( frame->background ) cairo_surface_destroy( frame->background );
+  frame->background = NULL;
+}
+
+/* initialize a frame. */
+void plotincFrameInit(plotincFrame *frame)
+{
+  frame->title[0] = '\0';
+  _plotincAxisInit( &frame->xaxis );
+  _plotincAxisInit( &frame->yaxis );
+  _plotincAxisInit( &frame->y2axis );
+  frame->font_face = NULL;
+  frame->scaled_font = NULL;
+  frame->font_options = NULL;
+  frame->background = NULL;
+  plotincFrameSetFont( frame, PLOTINC_DEFAULT_FONT_SIZE, PLOTINC_DEFAULT_FONT );
+  plotincFrameResize( frame, 0, 0, 0, 0 );
+  plotincFrameEnableXTics( frame );
+  plotincFrameEnableYTics( frame );
+  frame->draw = NULL;
+  frame->decimation = PLOTINC_DECIMATION_NONE;
+  frame->simplify_tolerance = PLOTINC_SIMPLIFY_TOLERANCE;
+  frame->range_clip = 0;
+  frame->pyramid = NULL;
+  frame->series_list = NULL;
+  frame->scroll_width = 0;
+  frame->flag_title = false;
+  frame->flag_scroll = false;
+  plotincFrameDisableAdaptiveSampling( frame );
+  plotincFrameDisableParallelSampling( frame );
+#ifdef PLOTINC_PROFILE
+  if( !( frame->stats = calloc( 1, sizeof(plotincStats) ) ) )
+    fprintf( stderr, "cannot allocate memory for statistics of a frame.\n" );
+#else
+  frame->stats = NULL;
+#endif
+  frame->canvas = NULL;
+  frame->next = NULL;
+}
+
+/* destroy a frame. */
+void plotincFrameDestroy(plotincFrame *frame)
+{
+  plotincSeries *series;
+
+  while( frame->series_list ){
+    series = frame->series_list->next;
+    _plotincSeriesFree( frame->series_list );
+    frame->series_list = series;
+  }
+  _plotincFrameReleaseFont( frame );
+  _plotincFrameInvalidate( frame );
+  free( frame->xaxis.tics_cache );
+  free( frame->yaxis.tics_cache );
+  free( frame->y2axis.tics_cache );
+  frame->xaxis.tics_cache = frame->yaxis.tics_cache = frame->y2axis.tics_cache = NULL;
+  free( frame->stats );
+  frame->stats = NULL;
+}
+
+void plotincFrameSetTitle(plotincFrame *frame, const char *title)
+{
+  if( title && title[0] ){
+    strncpy( frame->title, title, PLOTINC_FRAMESTR_MAXSIZE-1 );
+    frame->flag_title = true;
+  } else{
+    frame->title[0] = '\0';
+    frame->flag_title = false;
+  }
+  _plotincFrameInvalidate( frame );
+}
+
+void plotincFrameEnableXTics(plotincFrame *frame){ frame->xaxis.flag_tics = true; _plotincFrameInvalidate( frame ); }
+void plotincFrameEnableXGrid(plotincFrame *frame){ frame->xaxis.flag_grid = true; _plotincFrameInvalidate( frame ); }
+void plotincFrameEnableXLabel(plotincFrame *frame){ frame->xaxis.flag_label = true; _plotincFrameInvalidate( frame ); }
+void plotincFrameEnableYTics(plotincFrame *frame){ frame->yaxis.flag_tics = true; _plotincFrameInvalidate( frame ); }
+void plotincFrameEnableYGrid(plotincFrame *frame){ frame->yaxis.flag_grid = true; _plotincFrameInvalidate( frame ); }
+void plotincFrameEnableYLabel(plotincFrame *frame){ frame->yaxis.flag_label = true; _plotincFrameInvalidate( frame ); }
+void plotincFrameEnableY2Tics(plotincFrame *frame){ frame->y2axis.flag_tics = true; _plotincFrameInvalidate( frame ); }
+void plotincFrameEnableY2Grid(plotincFrame *frame){ frame->y2axis.flag_grid = true; _plotincFrameInvalidate( frame ); }
+void plotincFrameEnableY2Label(plotincFrame *frame){ frame->y2axis.flag_label = true; _plotincFrameInvalidate( frame ); }
+
+void plotincFrameDisableXTics(plotincFrame *frame){ frame->xaxis.flag_tics = false; _plotincFrameInvalidate( frame ); }
+void plotincFrameDisableXGrid(plotincFrame *frame){ frame->xaxis.flag_grid = false; _plotincFrameInvalidate( frame ); }
+void plotincFrameDisableXLabel(plotincFrame *frame){ frame->xaxis.flag_label = false; _plotincFrameInvalidate( frame ); }
+void plotincFrameDisableYTics(plotincFrame *frame){ frame->yaxis.flag_tics = false; _plotincFrameInvalidate( frame ); }
+void plotincFrameDisableYGrid(plotincFrame *frame){ frame->yaxis.flag_grid = false; _plotincFrameInvalidate( frame ); }
+void plotincFrameDisableYLabel(plotincFrame *frame){ frame->yaxis.flag_label = false; _plotincFrameInvalidate( frame ); }
+void plotincFrameDisableY2Tics(plotincFrame *frame){ frame->y2axis.flag_tics = false; _plotincFrameInvalidate( frame ); }
+void plotincFrameDisableY2Grid(plotincFrame *frame){ frame->y2axis.flag_grid = false; _plotincFrameInvalidate( frame ); }
+void plotincFrameDisableY2Label(plotincFrame *frame){ frame->y2axis.flag_label = false; _plotincFrameInvalidate( frame ); }
+
+/* resize a frame. */
+void plotincFrameResize(plotincFrame *frame, int ox, int oy, int width, int height)
+{
+  frame->baseline_skip = frame->font_pts * 4.0 / 3.0; /* assuming 96ppi */
+  frame->ox = ox;
+  frame->oy = oy;
+  frame->width = width;
+  frame->height = height;
+  frame->plot_ox = ox + frame->baseline_skip * 2 + PLOTINC_BASELINE_MARGIN;
+  frame->plot_oy = oy + frame->baseline_skip + PLOTINC_BASELINE_MARGIN;
+  frame->plot_width = frame->width - frame->baseline_skip * 4 - PLOTINC_BASELINE_MARGIN * 2;
+  frame->plot_height = frame->height - frame->baseline_skip * 3 - PLOTINC_BASELINE_MARGIN * 2;
+  _plotincFrameInvalidate( frame );
+}
+
+/* set font of a frame. */
+void plotincFrameSetFont(plotincFrame *frame, int size, char *fontname)
+{
+  _plotincFrameReleaseFont( frame );
+  _plotincFrameInvalidate( frame );
+  frame->font_pts = size;
+  strncpy( frame->font_name, fontname, PLOTINC_FONTNAME_MAXSIZE-1 );
+}
+
+/* set decimation method to plot data on a frame. */
+void plotincFrameSetDecimation(plotincFrame *frame, plotincDecimation decimation)
+{
+  frame->decimation = decimation;
+}
+
+/* set tolerance in pixels to simplify paths of plotted data on vector
+ * surfaces. Simplification is disabled if the tolerance is zero. */
+void plotincFrameSetSimplifyTolerance(plotincFrame *frame, double tolerance)
+{
+  frame->simplify_tolerance = tolerance > 0 ? tolerance : 0;
+}
+
+/* set fraction of data clipped at each of the lower and upper tails, when
+ * ranges of a frame are set based on data, so that a few outliers do not
+ * flatten the plot. The boundaries are approximated by a histogram. */
+void plotincFrameSetRangeClip(plotincFrame *frame, double fraction)
+{
+  frame->range_clip = fraction > 0 ? ( fraction < 0.5 ? fraction : 0.5 ) : 0;
+}
+
+/* set x-range of a frame. */
+void plotincFrameSetXRange(plotincFrame *frame, double min, double max)
+{
+  _plotincAxisSetRange( &frame->xaxis, min, max );
+  _plotincFrameInvalidate( frame );
+}
+
+/* set y-range of a frame. */
+void plotincFrameSetYRange(plotincFrame *frame, double min, double max)
+{
+  _plotincAxisSetRange( &frame->yaxis, min, max );
+  _plotincFrameInvalidate( frame );
+}
+
+/* set y2-range of a frame. */
+void plotincFrameSetY2Range(plotincFrame *frame, double min, double max)
+{
+  _plotincAxisSetRange( &frame->y2axis, min, max );
+  _plotincFrameInvalidate( frame );
+}
+
+/* resolve font of a frame to a scaled font kept until the font, the font
+ * options of the target or the transformation of the context is changed,
+ * and prepare caches of tic values. */
+static void _plotincFrameResolveFont(plotincFrame *frame, cairo_t *cairo)
+{
+  cairo_matrix_t font_matrix, ctm;
+  cairo_font_options_t *options;
+
+  if( !frame->xaxis.tics_cache && ( frame->xaxis.tics_cache = malloc( sizeof(plotincTicsCache) ) ) )
+    frame->xaxis.tics_cache->num = 0;
+  if( !frame->yaxis.tics_cache && ( frame->yaxis.tics_cache = malloc( sizeof(plotincTicsCache) ) ) )
+    frame->yaxis.tics_cache->num = 0;
+  if( !frame->y2axis.tics_cache && ( frame->y2axis.tics_cache = malloc( sizeof(plotincTicsCache) ) ) )
+    frame->y2axis.tics_cache->num = 0;
+  options = cairo_font_options_create();
+  cairo_surface_get_font_options( cairo_get_target( cairo ), options );
+  cairo_get_matrix( cairo, &ctm );
+  ctm.x0 = ctm.y0 = 0; /* glyphs do not depend on translation */
+  if( frame->scaled_font ){
+    if( cairo_font_options_equal( options, frame->font_options ) &&
+        ctm.xx == frame->font_ctm.xx && ctm.yx == frame->font_ctm.yx &&
+        ctm.xy == frame->font_ctm.xy && ctm.yy == frame->font_ctm.yy ){
+      cairo_font_options_destroy( options );
+      return;
+    }
+    /* extents of tic labels and the background layer depend on the scaled font */
+    _plotincFrameReleaseFont( frame );
+    _plotincFrameInvalidate( frame );
+  }
+  frame->font_face = cairo_toy_font_face_create( frame->font_name, CAIRO_FONT_SLANT_NORMAL, CAIRO_FONT_WEIGHT_NORMAL );
+  cairo_matrix_init_scale( &font_matrix, frame->font_pts, frame->font_pts );
+  frame->scaled_font = cairo_scaled_font_create( frame->font_face, &font_matrix, &ctm, options );
+  frame->font_options = options;
+  frame->font_ctm = ctm;
+  if( cairo_scaled_font_status( frame->scaled_font ) != CAIRO_STATUS_SUCCESS )
+    _plotincFrameReleaseFont( frame );
+}
+
+/* recall font of a frame. */
+static void _plotincFrameRecallFont(const plotincFrame *frame, cairo_t *cairo)
+{
+  cairo_set_source_rgb( cairo, 0, 0, 0 ); /* black */
+  if( frame->scaled_font ){
+    cairo_set_scaled_font( cairo, frame->scaled_font );
+    return;
+  }
+  cairo_set_font_size( cairo, frame->font_pts );
+  cairo_select_font_face( cairo, frame->font_name, CAIRO_FONT_SLANT_NORMAL, CAIRO_FONT_WEIGHT_NORMAL );
+}
+
+/* formatted string of a tic value and its extents, looked up in the cache of an axis. */
+static const char *_plotincFrameTicsLabel(const plotincFrame *frame, const plotincAxis *axis, cairo_t *cairo, double val, char *buf, cairo_text_extents_t *te)
+{
+  plotincTicsCache *cache;
+  plotincTicsLabel *label;
+  int i;
+
+  if( ( cache = frame->scaled_font ? axis->tics_cache : NULL ) )
+    for( i=0; i<cache->num; i++ )
+      if( cache->label[i].val == val ){
+        *te = cache->label[i].te;
+        return cache->label[i].str;
+      }
+  snprintf( buf, PLOTINC_TICSSTR_MAXSIZE, "%g", val );
+  cairo_text_extents( cairo, buf, te );
+  if( cache && cache->num < PLOTINC_TICSCACHE_MAXSIZE ){
+    label = &cache->label[cache->num++];
+    label->val = val;
+    strcpy( label->str, buf );
+    label->te = *te;
+  }
+  return buf;
+}
+
+/* set x-label of a frame. */
+void plotincFrameSetXLabel(plotincFrame *frame, const char *label)
+{
+  _plotincAxisSetLabel( &frame->xaxis, label );
+  _plotincFrameInvalidate( frame );
+}
+
+/* set y-label of a frame. */
+void plotincFrameSetYLabel(plotincFrame *frame, const char *label)
+{
+  _plotincAxisSetLabel( &frame->yaxis, label );
+  _plotincFrameInvalidate( frame );
+}
+
+/* set y2-label of a frame. */
+void plotincFrameSetY2Label(plotincFrame *frame, const char *label)
+{
+  _plotincAxisSetLabel( &frame->y2axis, label );
+  _plotincFrameInvalidate( frame );
+}
+
+/* transform from x-values to x-component of coordinates of a frame. */
+plotincTransform plotincFrameXTransform(const plotincFrame *frame)
+{
+  plotincTransform transform;
+
+  transform.scale = frame->plot_width / ( frame->xaxis.range_max - frame->xaxis.range_min );
+  transform.offset = frame->plot_ox - transform.scale * frame->xaxis.range_min;
+  return transform;
+}
+
+static plotincTransform _plotincFrameVerticalTransform(const plotincFrame *frame, const plotincAxis *axis)
+{
+  plotincTransform transform;
+
+  transform.scale = -frame->plot_height / ( axis->range_max - axis->range_min );
+  transform.offset = frame->plot_oy + frame->plot_height - transform.scale * axis->range_min;
+  return transform;
+}
+
+/* transform from y-values to y-component of coordinates of a frame. */
+plotincTransform plotincFrameYTransform(const plotincFrame *frame)
+{
+  return _plotincFrameVerticalTransform( frame, &frame->yaxis );
+}
+
+/* transform from y2-values to y-component of coordinates of a frame. */
+plotincTransform plotincFrameY2Transform(const plotincFrame *frame)
+{
+  return _plotincFrameVerticalTransform( frame, &frame->y2axis );
+}
+
+/* convert a double-precision value to x-component of coordinates. */
+int plotincFrameXCoord(const plotincFrame *frame, double x)
+{
+  plotincTransform transform = plotincFrameXTransform( frame );
+  return _plotincTransformApplyInt( &transform, x );
+}
+
+/* convert a double-precision value to y-component of coordinates. */
+int plotincFrameYCoord(const plotincFrame *frame, double y)
+{
+  plotincTransform transform = plotincFrameYTransform( frame );
+  return _plotincTransformApplyInt( &transform, y );
+}
+
+/* convert a double-precision value to y2-component of coordinates. */
+int plotincFrameY2Coord(const plotincFrame *frame, double y)
+{
+  plotincTransform transform = plotincFrameY2Transform( frame );
+  return _plotincTransformApplyInt( &transform, y );
+}
+
+/* draw title of a frame. */
+void plotincFrameDrawTitle(const plotincFrame *frame, cairo_t *cairo)
+{
+  cairo_text_extents_t te;
+
+  if( frame->title[0] ){
+    _plotincFrameRecallFont( frame, cairo );
+    cairo_text_extents( cairo, frame->title, &te );
+    cairo_move_to( cairo,
+      frame->plot_ox + ( frame->plot_width - te.width ) / 2,
+      frame->plot_oy - PLOTINC_BASELINE_MARGIN );
+    cairo_show_text( cairo, frame->title );
+  }
+}
+
+/* draw border lines of a frame. */
+void plotincFrameDrawBorder(const plotincFrame *frame, cairo_t *cairo)
+{
+  int zero;
+
+  cairo_set_source_rgb( cairo, 0, 0, 0 ); /* black */
+  /* border */
+  cairo_set_line_width( cairo, PLOTINC_BORDER_LINEWIDTH );
+  cairo_rectangle( cairo, frame->plot_ox, frame->plot_oy, frame->plot_width, frame->plot_height );
+  /* x-axis */
+  cairo_set_line_width( cairo, PLOTINC_AXIS_LINEWIDTH );
+  if( _plotincAxisZeroIsIncluded( &frame->yaxis ) ){
+    zero = plotincFrameYCoord( frame, 0 );
+    cairo_move_to( cairo, frame->plot_ox, zero );
+    cairo_rel_line_to( cairo, frame->plot_width, 0 );
+  }
+  /* y-axis */
+  if( _plotincAxisZeroIsIncluded( &frame->xaxis ) ){
+    zero = plotincFrameXCoord( frame, 0 );
+    cairo_move_to( cairo, zero, frame->plot_oy );
+    cairo_rel_line_to( cairo, 0, frame->plot_height );
+  }
+  cairo_stroke( cairo );
+}
+
+static void _plotincFrameDrawXTicsOne(const plotincFrame *frame, cairo_t *cairo, int xtics, int y, int dy)
+{
+  cairo_move_to( cairo, xtics, frame->plot_oy + y );
+  cairo_rel_line_to( cairo, 0, dy );
+  cairo_stroke( cairo );
+}
+static void _plotincFrameDrawBottomXTicsOne(const plotincFrame *frame, cairo_t *cairo, int xtics)
+{
+  cairo_set_line_width( cairo, PLOTINC_TICS_LINEWIDTH );
+  _plotincFrameDrawXTicsOne( frame, cairo, xtics, frame->plot_height, -PLOTINC_TICSLENGTH );
+}
+static void _plotincFrameDrawTopXTicsOne(const plotincFrame *frame, cairo_t *cairo, int xtics)
+{
+  cairo_set_line_width( cairo, PLOTINC_TICS_LINEWIDTH );
+  _plotincFrameDrawXTicsOne( frame, cairo, xtics, 0, PLOTINC_TICSLENGTH );
+}
+static void _plotincFrameDrawXTicsVal(const plotincFrame *frame, cairo_t *cairo, double val, int xtics)
+{
+  cairo_text_extents_t te;
+  char buf[PLOTINC_TICSSTR_MAXSIZE];
+  const char *str;
+
+  _plotincFrameRecallFont( frame, cairo );
+  str = _plotincFrameTicsLabel( frame, &frame->xaxis, cairo, val, buf, &te );
+  cairo_move_to( cairo, xtics - te.width / 2, frame->plot_oy + frame->plot_height + frame->baseline_skip );
+  cairo_show_text( cairo, str );
+}
+static void _plotincFrameDrawXTics(const plotincFrame *frame, cairo_t *cairo, double val, int tics)
+{
+  _plotincFrameDrawTopXTicsOne( frame, cairo, tics );
+  _plotincFrameDrawBottomXTicsOne( frame, cairo, tics );
+  _plotincFrameDrawXTicsVal( frame, cairo, val, tics );
+}
+
+static void _plotincFrameDrawYTicsOne(const plotincFrame *frame, cairo_t *cairo, int ytics, int x, int dx)
+{
+  cairo_move_to( cairo, frame->plot_ox + x, ytics );
+  cairo_rel_line_to( cairo, dx, 0 );
+  cairo_stroke( cairo );
+}
+static void _plotincFrameDrawLeftYTicsOne(const plotincFrame *frame, cairo_t *cairo, int ytics)
+{
+  cairo_set_line_width( cairo, PLOTINC_TICS_LINEWIDTH );
+  _plotincFrameDrawYTicsOne( frame, cairo, ytics, 0, PLOTINC_TICSLENGTH );
+}
+static void _plotincFrameDrawRightYTicsOne(const plotincFrame *frame, cairo_t *cairo, int ytics)
+{
+  cairo_set_line_width( cairo, PLOTINC_TICS_LINEWIDTH );
+  _plotincFrameDrawYTicsOne( frame, cairo, ytics, frame->plot_width, -PLOTINC_TICSLENGTH );
+}
+static void _plotincFrameDrawYTicsVal(const plotincFrame *frame, cairo_t *cairo, double val, int ytics)
+{
+  cairo_text_extents_t te;
+  char buf[PLOTINC_TICSSTR_MAXSIZE];
+  const char *str;
+
+  _plotincFrameRecallFont( frame, cairo );
+  str = _plotincFrameTicsLabel( frame, &frame->yaxis, cairo, val, buf, &te );
+  cairo_move_to( cairo, frame->plot_ox - te.width - PLOTINC_BASELINE_MARGIN, ytics + te.height/2 );
+  cairo_show_text( cairo, str );
+}
+static void _plotincFrameDrawYTics(const plotincFrame *frame, cairo_t *cairo, double val, int tics)
+{
+  _plotincFrameDrawLeftYTicsOne( frame, cairo, tics );
+  _plotincFrameDrawYTicsVal( frame, cairo, val, tics );
+}
+
+static void _plotincFrameDrawY2TicsVal(const plotincFrame *frame, cairo_t *cairo, double val, int ytics)
+{
+  cairo_text_extents_t te;
+  char buf[PLOTINC_TICSSTR_MAXSIZE];
+  const char *str;
+
+  _plotincFrameRecallFont( frame, cairo );
+  str = _plotincFrameTicsLabel( frame, &frame->y2axis, cairo, val, buf, &te );
+  cairo_move_to( cairo, frame->plot_ox +frame->plot_width + PLOTINC_BASELINE_MARGIN, ytics + te.height/2 );
+  cairo_show_text( cairo, str );
+}
+static void _plotincFrameDrawY2Tics(const plotincFrame *frame, cairo_t *cairo, double val, int tics)
+{
+  _plotincFrameDrawRightYTicsOne( frame, cairo, tics );
+  _plotincFrameDrawY2TicsVal( frame, cairo, val, tics );
+}
+
+/* draw x-tics of a frame. */
+void plotincFrameDrawXTics(const plotincFrame *frame, cairo_t *cairo)
+{
+  double tics_width, val;
+  int i, tics;
+
+  cairo_set_source_rgb( cairo, 0, 0, 0 ); /* black */
+  tics_width = _plotincAxisTicsWidth( &frame->xaxis );
+  if( frame->xaxis.range_max > 0 && frame->xaxis.range_min < 0 ){
+    for( i=0; ( tics = plotincFrameXCoord( frame, ( val =-i * tics_width ) ) ) >= frame->plot_ox; i++ )
+      _plotincFrameDrawXTics( frame, cairo, val, tics );
+    for( i=1; ( tics = plotincFrameXCoord( frame, ( val = i * tics_width ) ) ) <= frame->plot_ox + frame->plot_width; i++ )
+      _plotincFrameDrawXTics( frame, cairo, val, tics );
+  } else{
+    for( i=0; ; i++ ){
+      tics = plotincFrameXCoord( frame, ( val = _plotincAxisTicsVal( &frame->xaxis, tics_width, i ) ) );
+      if( tics >= frame->plot_ox && tics <= frame->plot_ox + frame->plot_width )
+        _plotincFrameDrawXTics( frame, cairo, val, tics );
+      if( i > frame->xaxis.tics_num ) break;
+    }
+  }
+}
+
+/* draw y-tics of a frame. */
+void plotincFrameDrawYTics(const plotincFrame *frame, cairo_t *cairo)
+{
+  double tics_width, val;
+  int i, tics;
+
+  cairo_set_source_rgb( cairo, 0, 0, 0 ); /* black */
+  tics_width = _plotincAxisTicsWidth( &frame->yaxis );
+  if( frame->yaxis.range_max > 0 && frame->yaxis.range_min < 0 ){
+    for( i=0; ( tics = plotincFrameYCoord( frame, ( val =-i * tics_width ) ) ) <= frame->plot_oy + frame->plot_height; i++ )
+      _plotincFrameDrawYTics( frame, cairo, val, tics );
+    for( i=1; ( tics = plotincFrameYCoord( frame, ( val = i * tics_width ) ) ) >= frame->plot_oy; i++ )
+      _plotincFrameDrawYTics( frame, cairo, val, tics );
+  } else{
+    for( i=0; ; i++ ){
+      tics = plotincFrameYCoord( frame, ( val = _plotincAxisTicsVal( &frame->yaxis, tics_width, i ) ) );
+      if( tics >= frame->plot_oy && tics <= frame->plot_oy + frame->plot_height )
+        _plotincFrameDrawYTics( frame, cairo, val, tics );
+      if( i > frame->yaxis.tics_num ) break;
+    }
+  }
+}
+
+/* draw y2-tics of a frame. */
+void plotincFrameDrawY2Tics(const plotincFrame *frame, cairo_t *cairo)
 {
   double tics_width, val;
   int i, tics;
 
-  cairo_set_source_rgb( cairo, 0, 0, 0 ); /* black */
-  tics_width = _plotincAxisTicsWidth( &frame->y2axis );
-  if( frame->y2axis.range_max > 0 && frame->y2axis.range_min < 0 ){
-    for( i=0; ( tics = plotincFrameY2Coord( frame, ( val =-i * tics_width ) ) ) <= frame->plot_oy + frame->plot_height; i++ )
-      _plotincFrameDrawY2Tics( frame, cairo, val, tics );
-    for( i=1; ( tics = plotincFrameY2Coord( frame, ( val = i * tics_width ) ) ) >= frame->plot_oy; i++ )
-      _plotincFrameDrawY2Tics( frame, cairo, val, tics );
-  } else{
-    for( i=0; ; i++ ){
-      tics = plotincFrameY2Coord( frame, ( val = _plotincAxisTicsVal( &frame->y2axis, tics_width, i ) ) );
-      if( tics >= frame->plot_oy && tics <= frame->plot_oy + frame->plot_height )
-        _plotincFrameDrawY2Tics( frame, cairo, val, tics );
-      if( i > frame->y2axis.tics_num ) break;
+  cairo_set_source_rgb( cairo, 0, 0, 0 ); /* black */
+  tics_width = _plotincAxisTicsWidth( &frame->y2axis );
+  if( frame->y2axis.range_max > 0 && frame->y2axis.range_min < 0 ){
+    for( i=0; ( tics = plotincFrameY2Coord( frame, ( val =-i * tics_width ) ) ) <= frame->plot_oy + frame->plot_height; i++ )
+      _plotincFrameDrawY2Tics( frame, cairo, val, tics );
+    for( i=1; ( tics = plotincFrameY2Coord( frame, ( val = i * tics_width ) ) ) >= frame->plot_oy; i++ )
+      _plotincFrameDrawY2Tics( frame, cairo, val, tics );
+  } else{
+    for( i=0; ; i++ ){
+      tics = plotincFrameY2Coord( frame, ( val = _plotincAxisTicsVal( &frame->y2axis, tics_width, i ) ) );
+      if( tics >= frame->plot_oy && tics <= frame->plot_oy + frame->plot_height )
+        _plotincFrameDrawY2Tics( frame, cairo, val, tics );
+      if( i > frame->y2axis.tics_num ) break;
+    }
+  }
+}
+
+/* set grid line property of a frame. */
+static void _plotincFrameSetGridLine(cairo_t *cairo)
+{
+  double dash[] = { 6.0, 10.0 };
+  cairo_set_source_rgb( cairo, 0, 0, 0 ); /* black */
+  cairo_set_line_width( cairo, PLOTINC_GRID_LINEWIDTH );
+  cairo_set_dash( cairo, dash, sizeof(dash)/sizeof(double), 0 );
+}
+
+/* draw x-grid of a frame. */
+void plotincFrameDrawXGrid(const plotincFrame *frame, cairo_t *cairo)
+{
+  double tics_width;
+  int i, tics;
+
+  _plotincFrameSetGridLine( cairo );
+  cairo_set_source_rgb( cairo, 0, 0, 0 ); /* black */
+  tics_width = _plotincAxisTicsWidth( &frame->xaxis );
+  if( frame->xaxis.range_max > 0 && frame->xaxis.range_min < 0 ){
+    for( i=1; ( tics = plotincFrameXCoord( frame,-i * tics_width ) ) > frame->plot_ox; i++ )
+      _plotincFrameDrawXTicsOne( frame, cairo, tics, 0, frame->plot_height );
+    for( i=1; ( tics = plotincFrameXCoord( frame, i * tics_width ) ) < frame->plot_ox + frame->plot_width; i++ )
+      _plotincFrameDrawXTicsOne( frame, cairo, tics, 0, frame->plot_height );
+  } else{
+    for( i=0; ; i++ ){
+      tics = plotincFrameXCoord( frame,  _plotincAxisTicsVal( &frame->xaxis, tics_width, i ) );
+      if( tics > frame->plot_ox && tics < frame->plot_ox + frame->plot_width )
+        _plotincFrameDrawXTicsOne( frame, cairo, tics, 0, frame->plot_height );
+      if( i > frame->xaxis.tics_num ) break;
+    }
+  }
+  cairo_set_dash( cairo, NULL, 0, 0 );
+}
+
+/* draw y-grid of a frame. */
+void plotincFrameDrawYGrid(const plotincFrame *frame, cairo_t *cairo)
+{
+  double tics_width;
+  int i, tics;
+
+  _plotincFrameSetGridLine( cairo );
+  tics_width = _plotincAxisTicsWidth( &frame->yaxis );
+  if( frame->yaxis.range_max > 0 && frame->yaxis.range_min < 0 ){
+    for( i=1; ( tics = plotincFrameYCoord( frame,-i * tics_width ) ) < frame->plot_oy + frame->plot_height; i++ )
+      _plotincFrameDrawYTicsOne( frame, cairo, tics, 0, frame->plot_width );
+    for( i=1; ( tics = plotincFrameYCoord( frame, i * tics_width ) ) > frame->plot_oy; i++ )
+      _plotincFrameDrawYTicsOne( frame, cairo, tics, 0, frame->plot_width );
+  } else{
+    for( i=0; ; i++ ){
+      tics = plotincFrameYCoord( frame, _plotincAxisTicsVal( &frame->yaxis, tics_width, i ) );
+      if( tics > frame->plot_oy && tics < frame->plot_oy + frame->plot_height )
+        _plotincFrameDrawYTicsOne( frame, cairo, tics, 0, frame->plot_width );
+      if( i > frame->yaxis.tics_num ) break;
+    }
+  }
+  cairo_set_dash( cairo, NULL, 0, 0 );
+}
+
+/* set grid line property of a frame. */
+static void _plotincFrameSetY2GridLine(cairo_t *cairo)
+{
+  double dash[] = { 3.0, 5.0 };
+  cairo_set_source_rgb( cairo, 0, 0, 0 ); /* black */
+  cairo_set_line_width( cairo, PLOTINC_GRID_LINEWIDTH );
+  cairo_set_dash( cairo, dash, sizeof(dash)/sizeof(double), 0 );
+}
+
+/* draw y2-grid of a frame. */
+void plotincFrameDrawY2Grid(const plotincFrame *frame, cairo_t *cairo)
+{
+  double tics_width;
+  int i, tics;
+
+  _plotincFrameSetY2GridLine( cairo );
+  tics_width = _plotincAxisTicsWidth( &frame->y2axis );
+  if( frame->y2axis.range_max > 0 && frame->y2axis.range_min < 0 ){
+    for( i=1; ( tics = plotincFrameY2Coord( frame,-i * tics_width ) ) < frame->plot_oy + frame->plot_height; i++ )
+      _plotincFrameDrawYTicsOne( frame, cairo, tics, 0, frame->plot_width );
+    for( i=1; ( tics = plotincFrameY2Coord( frame, i * tics_width ) ) > frame->plot_oy; i++ )
+      _plotincFrameDrawYTicsOne( frame, cairo, tics, 0, frame->plot_width );
+  } else{
+    for( i=0; ; i++ ){
+      tics = plotincFrameY2Coord( frame, _plotincAxisTicsVal( &frame->y2axis, tics_width, i ) );
+      if( tics > frame->plot_oy && tics < frame->plot_oy + frame->plot_height )
+        _plotincFrameDrawYTicsOne( frame, cairo, tics, 0, frame->plot_width );
+      if( i > frame->y2axis.tics_num ) break;
+    }
+  }
+  cairo_set_dash( cairo, NULL, 0, 0 );
+}
+
+/* draw label of a frame. */
+static void _plotincFrameDrawLabel(const plotincFrame *frame, cairo_t *cairo, const char *label, int x, int y, double angle)
+{
+  cairo_text_extents_t te;
+
+  if( !label[0] ) return;
+  _plotincFrameRecallFont( frame, cairo );
+  cairo_text_extents( cairo, label, &te );
+  cairo_save( cairo );
+  cairo_translate( cairo, x, y );
+  cairo_rotate( cairo, angle );
+  cairo_translate( cairo, -te.width/2, 0 );
+  cairo_move_to( cairo, 0, 0 );
+  cairo_show_text( cairo, label );
+  cairo_restore( cairo );
+}
+
+/* TeX source of a label. */
+static void _plotincTexSource(const char *label, char *src, size_t size)
+{
+  snprintf( src, size,
+    "\\documentclass{jarticle}\n"
+    "\\usepackage{amsmath,amssymb,bm}\n"
+    "\\begin{document}\n"
+    "%s\n"
+    "\\thispagestyle{empty}\n"
+    "\\end{document}\n", label );
+}
+
+/* 64-bit FNV-1a hash of a string. */
+static unsigned long long _plotincHash(const char *str)
+{
+  unsigned long long hash = 0xcbf29ce484222325ULL;
+
+  for( ; *str; str++ ){
+    hash ^= (unsigned char)*str;
+    hash *= 0x100000001b3ULL;
+  }
+  return hash;
+}
+
+/* render a TeX source to an image through platex, dvips, pstopnm and convert. */
+static cairo_surface_t *_plotincTexRender(const char *src)
+{
+  FILE *fp;
+  char tmpfile[PLOTINC_PATH_MAXSIZE], outfile[PLOTINC_PATH_MAXSIZE];
+  char cmd[BUFSIZ];
+  cairo_surface_t *image = NULL;
+  int fd;
+
+  strcpy( tmpfile, "_plotinc.XXXXXX" );
+  if( ( fd = mkstemp( tmpfile ) ) < 0 ){
+    fprintf( stderr, "cannot create temprary file name.\n" );
+    return NULL;
+  }
+  close( fd );
+  sprintf( outfile, "%s.tex", tmpfile );
+  if( !( fp = fopen( outfile, "w" ) ) ){
+    fprintf( stderr, "cannot open a temprary file.\n" );
+    goto TERMINATE;
+  }
+  fputs( src, fp );
+  fclose( fp ); /* temprary TeX file */
+
+  sprintf( cmd, "platex %s > /dev/null", outfile );
+  if( system( cmd ) == 0x7f ){
+    fprintf( stderr, "failed to make a DVI file.\n" );
+    goto TERMINATE;
+  }
+  sprintf( cmd, "dvips -E %s.dvi > /dev/null", tmpfile );
+  if( system( cmd ) == 0x7f ){
+    fprintf( stderr, "failed to make an EPS file.\n" );
+    goto TERMINATE;
+  }
+  sprintf( cmd, "pstopnm -portrait -pgm %s.ps > /dev/null", tmpfile );
+  if( system( cmd ) == 0x7f ){
+    fprintf( stderr, "failed to make a PGM file.\n" );
+    goto TERMINATE;
+  }
+  sprintf( cmd, "convert %s001.pgm %s.png > /dev/null", tmpfile, tmpfile );
+  if( system( cmd ) == 0x7f ){
+    fprintf( stderr, "failed to make a PNG file.\n" );
+    goto TERMINATE;
+  }
+  sprintf( outfile, "%s.png", tmpfile );
+  image = cairo_image_surface_create_from_png( outfile );
+  if( cairo_surface_status( image ) != CAIRO_STATUS_SUCCESS ){
+    cairo_surface_destroy( image );
+    image = NULL;
+  }
+ TERMINATE:
+  sprintf( cmd, "rm %s* > /dev/null", tmpfile );
+  if( system( cmd ) < 0 ){
+    fprintf( stderr, "cannot remove temporary files.\n" );
+  }
+  return image;
+}
+
+/* image of a label rendered by TeX, which is looked up in the caches in memory
+ * and on disk of the canvas before running TeX. A label failed to be rendered
+ * is also cached in memory without an image, so that TeX is not run again.
+ * The returned image has to be destroyed by the caller. */
+static cairo_surface_t *_plotincFrameTexLabelImage(const plotincFrame *frame, const char *label)
+{
+  plotincCanvas *canvas;
+  plotincTexLabel *texlabel;
+  char src[BUFSIZ], cachefile[PLOTINC_PATH_MAXSIZE+32];
+  cairo_surface_t *image = NULL;
+
+  if( ( canvas = frame->canvas ) ){
+    pthread_mutex_lock( &canvas->texcache_mutex );
+    for( texlabel=canvas->texlabel_list; texlabel; texlabel=texlabel->next )
+      if( strcmp( texlabel->label, label ) == 0 ){
+        if( texlabel->image ) image = cairo_surface_reference( texlabel->image );
+        break;
+      }
+    pthread_mutex_unlock( &canvas->texcache_mutex );
+    if( texlabel ){
+      PLOTINC_PROFILE_COUNT( texcache_hit_num, 1 );
+      return image;
+    }
+  }
+  _plotincTexSource( label, src, BUFSIZ );
+  cachefile[0] = '\0';
+  if( canvas && canvas->texcache_dir[0] ){
+    snprintf( cachefile, sizeof(cachefile), "%s/%016llx.png", canvas->texcache_dir, _plotincHash( src ) );
+    if( access( cachefile, R_OK ) == 0 ){
+      image = cairo_image_surface_create_from_png( cachefile );
+      if( cairo_surface_status( image ) != CAIRO_STATUS_SUCCESS ){
+        cairo_surface_destroy( image );
+        image = NULL;
+      } else{
+        PLOTINC_PROFILE_COUNT( texcache_hit_num, 1 );
+      }
+    }
+  }
+  if( !image ){
+    PLOTINC_PROFILE_BEGIN( t_tex );
+    image = _plotincTexRender( src );
+    PLOTINC_PROFILE_END( t_tex, PLOTINC_PHASE_TEX );
+    PLOTINC_PROFILE_COUNT( tex_num, 1 );
+    if( image && cachefile[0] && cairo_surface_write_to_png( image, cachefile ) != CAIRO_STATUS_SUCCESS )
+      fprintf( stderr, "cannot write a cache file %s.\n", cachefile );
+  }
+  if( canvas && ( texlabel = malloc( sizeof(plotincTexLabel) ) ) ){
+    strcpy( texlabel->label, label );
+    texlabel->image = image ? cairo_surface_reference( image ) : NULL;
+    pthread_mutex_lock( &canvas->texcache_mutex );
+    texlabel->next = canvas->texlabel_list;
+    canvas->texlabel_list = texlabel;
+    pthread_mutex_unlock( &canvas->texcache_mutex );
+  }
+  return image;
+}
+
+/* draw label in TeX format of a file. */
+static void _plotincFrameDrawTexLabel(const plotincFrame *frame, cairo_t *cairo, const char *label, int x, int y, double angle)
+{
+  cairo_surface_t *label_image;
+  int label_width, label_height;
+  double scale;
+
+  if( !label[0] ) return;
+  if( !( label_image = _plotincFrameTexLabelImage( frame, label ) ) ) return;
+  label_width = cairo_image_surface_get_width( label_image );
+  label_height = cairo_image_surface_get_height( label_image );
+  cairo_save( cairo );
+  scale = (double)frame->baseline_skip / label_height;
+  cairo_translate( cairo, x, y );
+  cairo_rotate( cairo, angle );
+  cairo_scale( cairo, scale, scale );
+  cairo_translate( cairo,-label_width/2, 0 );
+  cairo_set_source_surface( cairo, label_image, 0, 0 );
+  cairo_paint( cairo );
+  cairo_restore( cairo );
+  cairo_surface_destroy( label_image );
+}
+
+/* draw x-label of a frame. */
+void plotincFrameDrawXLabel(const plotincFrame *frame, cairo_t *cairo)
+{
+  if( strchr( frame->xaxis.label, '$' ) ){
+    _plotincFrameDrawTexLabel( frame, cairo, frame->xaxis.label,
+      frame->plot_ox + frame->plot_width/2,
+      frame->plot_oy + frame->plot_height + frame->baseline_skip + PLOTINC_BASELINE_MARGIN*2,
+      0 );
+  } else{
+    _plotincFrameDrawLabel( frame, cairo, frame->xaxis.label,
+      frame->plot_ox + frame->plot_width/2,
+      frame->plot_oy + frame->plot_height + frame->baseline_skip*2,
+      0 );
+  }
+}
+
+/* draw y-label of a frame. */
+void plotincFrameDrawYLabel(const plotincFrame *frame, cairo_t *cairo)
+{
+  if( strchr( frame->yaxis.label, '$' ) ){
+    _plotincFrameDrawTexLabel( frame, cairo, frame->yaxis.label,
+      frame->plot_ox - frame->baseline_skip*2 - PLOTINC_BASELINE_MARGIN,
+      frame->plot_oy + frame->plot_height/2,
+      -M_PI/2 );
+  } else{
+    _plotincFrameDrawLabel( frame, cairo, frame->yaxis.label,
+      frame->plot_ox - frame->baseline_skip - PLOTINC_BASELINE_MARGIN,
+      frame->plot_oy + frame->plot_height/2,
+     -M_PI/2 );
+  }
+}
+
+/* draw y2-label of a frame. */
+void plotincFrameDrawY2Label(const plotincFrame *frame, cairo_t *cairo)
+{
+  if( strchr( frame->y2axis.label, '$' ) ){
+    _plotincFrameDrawTexLabel( frame, cairo, frame->y2axis.label,
+      frame->plot_ox + frame->plot_width + frame->baseline_skip + PLOTINC_BASELINE_MARGIN,
+      frame->plot_oy + frame->plot_height/2,
+      -M_PI/2 );
+  } else{
+    _plotincFrameDrawLabel( frame, cairo, frame->y2axis.label,
+      frame->plot_ox + frame->plot_width + frame->baseline_skip*2 + PLOTINC_BASELINE_MARGIN,
+      frame->plot_oy + frame->plot_height/2,
+     -M_PI/2 );
+  }
+}
+
+/* draw grids, tics, labels, title and border of a frame. */
+static void _plotincFrameDrawDecoration(const plotincFrame *frame, cairo_t *cairo)
+{
+  PLOTINC_PROFILE_BEGIN( t_grid );
+  if( frame->xaxis.flag_grid  )  plotincFrameDrawXGrid(   frame, cairo );
+  if( frame->yaxis.flag_grid  )  plotincFrameDrawYGrid(   frame, cairo );
+  if( frame->y2axis.flag_grid  ) plotincFrameDrawY2Grid(  frame, cairo );
+  PLOTINC_PROFILE_END( t_grid, PLOTINC_PHASE_GRID );
+  PLOTINC_PROFILE_BEGIN( t_tics );
+  if( frame->xaxis.flag_tics  )  plotincFrameDrawXTics(   frame, cairo );
+  if( frame->yaxis.flag_tics  )  plotincFrameDrawYTics(   frame, cairo );
+  if( frame->y2axis.flag_tics  ) plotincFrameDrawY2Tics(  frame, cairo );
+  PLOTINC_PROFILE_END( t_tics, PLOTINC_PHASE_TICS );
+  PLOTINC_PROFILE_BEGIN( t_label );
+  if( frame->xaxis.flag_label )  plotincFrameDrawXLabel(  frame, cairo );
+  if( frame->yaxis.flag_label )  plotincFrameDrawYLabel(  frame, cairo );
+  if( frame->y2axis.flag_label ) plotincFrameDrawY2Label( frame, cairo );
+  if( frame->flag_title )        plotincFrameDrawTitle(   frame, cairo );
+  PLOTINC_PROFILE_END( t_label, PLOTINC_PHASE_LABEL );
+  PLOTINC_PROFILE_BEGIN( t_border );
+  plotincFrameDrawBorder( frame, cairo );
+  PLOTINC_PROFILE_END( t_border, PLOTINC_PHASE_BORDER );
+}
+
+/* make pixels of the raster background layer of a frame transparent where
+ * decorations do not touch, which are found by drawing them once more on a
+ * transparent image of the same format. */
+static bool _plotincFrameMaskBackground(plotincFrame *frame)
+{
+  cairo_surface_t *coverage;
+  cairo_t *cairo;
+  uint32_t *dst, *src;
+  int dst_stride, src_stride, i, j;
+
+  coverage = cairo_image_surface_create( CAIRO_FORMAT_ARGB32, frame->width, frame->height );
+  if( cairo_surface_status( coverage ) != CAIRO_STATUS_SUCCESS ){
+    cairo_surface_destroy( coverage );
+    return false;
+  }
+  cairo_surface_set_device_offset( coverage, -frame->ox, -frame->oy );
+  cairo = cairo_create( coverage );
+  _plotincFrameDrawDecoration( frame, cairo );
+  cairo_destroy( cairo );
+  cairo_surface_flush( coverage );
+  cairo_surface_flush( frame->background );
+  dst_stride = cairo_image_surface_get_stride( frame->background ) / sizeof(uint32_t);
+  src_stride = cairo_image_surface_get_stride( coverage ) / sizeof(uint32_t);
+  for( i=0; i<frame->height; i++ ){
+    dst = (uint32_t *)cairo_image_surface_get_data( frame->background ) + dst_stride * i;
+    src = (uint32_t *)cairo_image_surface_get_data( coverage ) + src_stride * i;
+    for( j=0; j<frame->width; j++ )
+      if( src[j] == 0 ) dst[j] = 0;
+  }
+  cairo_surface_mark_dirty( frame->background );
+  cairo_surface_destroy( coverage );
+  return true;
+}
+
+/* paint the background layer of a frame, which is rendered when missing.
+ * A raster layer holds the decorations drawn over white, and is transparent
+ * elsewhere so that it is composited over the target without erasing what
+ * is drawn there before, e.g. labels of a neighbouring frame spilling over
+ * the border; the decorated pixels are the same as those drawn directly
+ * unless something else is drawn under them. A vector layer is a recording
+ * surface replayed on the target. */
+static bool _plotincFramePaintBackground(plotincFrame *frame, cairo_t *cairo)
+{
+  cairo_t *layer_cairo;
+  bool flag_raster;
+
+  flag_raster = _plotincSurfaceIsRaster( cairo_get_target( cairo ) );
+  if( flag_raster && !_plotincIsPixelAligned( cairo ) ) return false;
+  if( frame->background && frame->flag_background_raster != flag_raster )
+    _plotincFrameInvalidate( frame );
+  if( frame->background )
+    PLOTINC_PROFILE_COUNT( background_hit_num, 1 );
+  else{
+    if( flag_raster ){
+      frame->background = cairo_image_surface_create( CAIRO_FORMAT_ARGB32, frame->width, frame->height );
+      cairo_surface_set_device_offset( frame->background, -frame->ox, -frame->oy );
+    } else
+      frame->background = cairo_recording_surface_create( CAIRO_CONTENT_COLOR_ALPHA, NULL );
+    if( cairo_surface_status( frame->background ) != CAIRO_STATUS_SUCCESS ){
+      _plotincFrameInvalidate( frame );
+      return false;
+    }
+    frame->flag_background_raster = flag_raster;
+    layer_cairo = cairo_create( frame->background );
+    if( flag_raster ){
+      cairo_set_source_rgb( layer_cairo, 1, 1, 1 ); /* white */
+      cairo_paint( layer_cairo );
+    }
+    _plotincFrameDrawDecoration( frame, layer_cairo );
+    cairo_destroy( layer_cairo );
+    if( flag_raster && !_plotincFrameMaskBackground( frame ) ){
+      _plotincFrameInvalidate( frame );
+      return false;
+    }
+  }
+  PLOTINC_PROFILE_BEGIN( t_background );
+  cairo_save( cairo );
+  cairo_set_source_surface( cairo, frame->background, 0, 0 );
+  cairo_paint( cairo );
+  cairo_restore( cairo );
+  PLOTINC_PROFILE_END( t_background, PLOTINC_PHASE_BACKGROUND );
+  /* leave the context as drawing the border does */
+  _plotincFrameRecallFont( frame, cairo );
+  cairo_set_line_width( cairo, PLOTINC_AXIS_LINEWIDTH );
+  return true;
+}
+
+#ifdef PLOTINC_PROFILE
+#define PLOTINC_PROFILE_ENTER(frame) plotincStats *stats_prev = _plotinc_stats; _plotinc_stats = (frame)->stats
+#define PLOTINC_PROFILE_LEAVE()      _plotinc_stats = stats_prev
+#else
+#define PLOTINC_PROFILE_ENTER(frame)
+#define PLOTINC_PROFILE_LEAVE()
+#endif /* PLOTINC_PROFILE */
+
+/* draw background, grids, tics, labels, title and border of a frame. */
+static void _plotincFrameDrawBase(plotincFrame *frame, cairo_t *cairo)
+{
+  PLOTINC_PROFILE_ENTER( frame );
+  PLOTINC_PROFILE_COUNT( draw_num, 1 );
+  PLOTINC_PROFILE_BEGIN( t_frame );
+  _plotincFrameResolveFont( frame, cairo );
+  if( !_plotincFramePaintBackground( frame, cairo ) )
+    _plotincFrameDrawDecoration( frame, cairo );
+  PLOTINC_PROFILE_END( t_frame, PLOTINC_PHASE_FRAME );
+  PLOTINC_PROFILE_LEAVE();
+}
+
+/* whether a frame has contents drawn in the plot region. */
+static bool _plotincFrameHasContent(const plotincFrame *frame)
+{
+  return frame->draw || frame->series_list;
+}
+
+/* draw contents of a frame, namely those by the drawing method and series,
+ * clipped in the plot region. */
+static void _plotincFrameDrawContent(plotincFrame *frame, cairo_t *cairo)
+{
+  if( !_plotincFrameHasContent( frame ) ) return;
+  PLOTINC_PROFILE_ENTER( frame );
+  PLOTINC_PROFILE_BEGIN( t_frame );
+  cairo_rectangle( cairo, frame->plot_ox, frame->plot_oy, frame->plot_width, frame->plot_height );
+  cairo_clip( cairo );
+  PLOTINC_PROFILE_BEGIN( t_draw );
+  if( frame->draw ) frame->draw( frame, cairo );
+  PLOTINC_PROFILE_END( t_draw, PLOTINC_PHASE_DRAW );
+  PLOTINC_PROFILE_BEGIN( t_series );
+  plotincFrameDrawSeries( frame, cairo );
+  PLOTINC_PROFILE_END( t_series, PLOTINC_PHASE_SERIES );
+  cairo_reset_clip( cairo );
+  PLOTINC_PROFILE_END( t_frame, PLOTINC_PHASE_FRAME );
+  PLOTINC_PROFILE_LEAVE();
+}
+
+/* draw a frame. */
+void plotincFrameDraw(plotincFrame *frame, cairo_t *cairo)
+{
+  _plotincFrameDrawBase( frame, cairo );
+  _plotincFrameDrawContent( frame, cairo );
+}
+
+/* statistics of drawing a frame. false is returned unless profiled. */
+bool plotincFrameStats(const plotincFrame *frame, plotincStats *stats)
+{
+  if( !frame->stats ) return false;
+  *stats = *frame->stats;
+  return true;
+}
+
+/* draw a 2D point on a frame. */
+void plotincFrameDrawPoint(const plotincFrame *frame, cairo_t *cairo, double x, double y, double size)
+{
+  int px, py;
+
+  if( ( px = plotincFrameXCoord( frame, x ) ) < 0 ) return;
+  if( ( py = plotincFrameYCoord( frame, y ) ) < 0 ) return;
+  cairo_move_to( cairo, px, py );
+  cairo_arc( cairo, px, py, size, 0, 2*M_PI );
+  cairo_fill( cairo );
+}
+
+/* draw a 2D line segment on a frame. */
+void plotincFrameDrawLine(const plotincFrame *frame, cairo_t *cairo, double x0, double y0, double x1, double y1)
+{
+  int px, py;
+
+  px = plotincFrameXCoord( frame, x0 );
+  py = plotincFrameYCoord( frame, y0 );
+  cairo_move_to( cairo, px, py );
+  px = plotincFrameXCoord( frame, x1 );
+  py = plotincFrameYCoord( frame, y1 );
+  cairo_line_to( cairo, px, py );
+  cairo_stroke( cairo );
+}
+
+/* add a path of a marker to the current path. */
+static void _plotincMarkerPath(cairo_t *cairo, plotincMarker marker, double x, double y, double size)
+{
+  cairo_new_sub_path( cairo );
+  switch( marker ){
+  case PLOTINC_MARKER_SQUARE:
+    cairo_rectangle( cairo, x - size, y - size, size*2, size*2 );
+    break;
+  case PLOTINC_MARKER_DIAMOND:
+    cairo_move_to( cairo, x, y - size );
+    cairo_line_to( cairo, x + size, y );
+    cairo_line_to( cairo, x, y + size );
+    cairo_line_to( cairo, x - size, y );
+    cairo_close_path( cairo );
+    break;
+  case PLOTINC_MARKER_TRIANGLE:
+    cairo_move_to( cairo, x, y - size );
+    cairo_line_to( cairo, x + size * 0.866, y + size * 0.5 );
+    cairo_line_to( cairo, x - size * 0.866, y + size * 0.5 );
+    cairo_close_path( cairo );
+    break;
+  default:
+    cairo_arc( cairo, x, y, size, 0, 2*M_PI );
+  }
+}
+
+/* scatter markers by stamping a pre-rendered sprite on an alpha mask of the
+ * plot region, which is then painted with the current source at once. */
+static bool _plotincFrameStampScatter(const plotincFrame *frame, cairo_t *cairo, const int px[], const int py[], int size, plotincMarker marker, double marker_size)
+{
+  cairo_surface_t *sprite, *mask;
+  cairo_t *sprite_cairo;
+  unsigned char *sprite_data, *mask_data, *s, *d;
+  int r, sprite_len, sprite_stride, mask_stride, i, x, y, x0, y0, x1, y1;
+
+  r = ceil( marker_size ) + 1;
+  sprite_len = r * 2 + 1;
+  sprite = cairo_image_surface_create( CAIRO_FORMAT_A8, sprite_len, sprite_len );
+  mask = cairo_image_surface_create( CAIRO_FORMAT_A8, frame->plot_width, frame->plot_height );
+  if( cairo_surface_status( sprite ) != CAIRO_STATUS_SUCCESS ||
+      cairo_surface_status( mask ) != CAIRO_STATUS_SUCCESS ){
+    cairo_surface_destroy( sprite );
+    cairo_surface_destroy( mask );
+    return false;
+  }
+  sprite_cairo = cairo_create( sprite );
+  _plotincMarkerPath( sprite_cairo, marker, r, r, marker_size );
+  cairo_fill( sprite_cairo );
+  cairo_destroy( sprite_cairo );
+  cairo_surface_flush( sprite );
+  sprite_data = cairo_image_surface_get_data( sprite );
+  sprite_stride = cairo_image_surface_get_stride( sprite );
+  mask_data = cairo_image_surface_get_data( mask );
+  mask_stride = cairo_image_surface_get_stride( mask );
+  for( i=0; i<size; i++ ){
+    /* sprite region clipped by the plot region */
+    x0 = px[i] - r - frame->plot_ox; x1 = x0 + sprite_len;
+    y0 = py[i] - r - frame->plot_oy; y1 = y0 + sprite_len;
+    for( y=( y0 < 0 ? 0 : y0 ); y<y1 && y<frame->plot_height; y++ ){
+      s = sprite_data + ( y - y0 ) * sprite_stride;
+      d = mask_data + y * mask_stride;
+      for( x=( x0 < 0 ? 0 : x0 ); x<x1 && x<frame->plot_width; x++ )
+        if( s[x-x0] ) d[x] += ( s[x-x0] * ( 255 - d[x] ) + 127 ) / 255;
+    }
+  }
+  cairo_surface_mark_dirty( mask );
+  cairo_mask_surface( cairo, mask, frame->plot_ox, frame->plot_oy );
+  cairo_surface_destroy( sprite );
+  cairo_surface_destroy( mask );
+  return true;
+}
+
+/* scatter markers on a frame.
+ * Points whose markers are out of the plot region are skipped. On raster
+ * surfaces, a pre-rendered sprite of the marker is stamped on each point;
+ * otherwise all markers are filled as one path. */
+void plotincFramePlotScatter(const plotincFrame *frame, cairo_t *cairo, const double xdata[], const double ydata[], int size, plotincMarker marker, double marker_size)
+{
+  plotincTransform xt, yt;
+  int *px, *py, i, n, x, y, margin;
+
+  if( size <= 0 ) return;
+  px = malloc( sizeof(int)*size );
+  py = malloc( sizeof(int)*size );
+  if( !px || !py ){
+    fprintf( stderr, "cannot allocate buffer for scatter plot.\n" );
+    goto TERMINATE;
+  }
+  xt = plotincFrameXTransform( frame );
+  yt = plotincFrameYTransform( frame );
+  plotincTransformDoubleArrayToInt( &xt, xdata, px, size );
+  plotincTransformDoubleArrayToInt( &yt, ydata, py, size );
+  margin = ceil( marker_size ) + 1;
+  for( n=0, i=0; i<size; i++ ){
+    x = px[i];
+    y = py[i];
+    if( x < frame->plot_ox - margin || x > frame->plot_ox + frame->plot_width  + margin ||
+        y < frame->plot_oy - margin || y > frame->plot_oy + frame->plot_height + margin ) continue;
+    px[n] = x;
+    py[n++] = y;
+  }
+  if( n == 0 ) goto TERMINATE;
+  if( _plotincSurfaceIsRaster( cairo_get_target( cairo ) ) && _plotincIsPixelAligned( cairo ) &&
+      _plotincFrameStampScatter( frame, cairo, px, py, n, marker, marker_size ) )
+    goto TERMINATE;
+  cairo_new_path( cairo );
+  for( i=0; i<n; i++ )
+    _plotincMarkerPath( cairo, marker, px[i], py[i], marker_size );
+  cairo_fill( cairo );
+ TERMINATE:
+  free( px );
+  free( py );
+}
+
+/* number of threads available to draw a frame. */
+static int _plotincFrameThreadNum(const plotincFrame *frame)
+{
+  return frame->canvas ? frame->canvas->thread_num : 1;
+}
+
+/* key of a number, whose order as an unsigned integer is that of numbers. */
+static inline uint64_t _plotincOrderedKey(double val)
+{
+  uint64_t bits;
+
+  memcpy( &bits, &val, sizeof(bits) );
+  return bits & 0x8000000000000000ULL ? ~bits : bits | 0x8000000000000000ULL;
+}
+
+/* number of a key given by _plotincOrderedKey(). */
+static inline double _plotincOrderedVal(uint64_t key)
+{
+  uint64_t bits;
+  double val;
+
+  bits = key & 0x8000000000000000ULL ? key & ~0x8000000000000000ULL : ~key;
+  memcpy( &val, &bits, sizeof(val) );
+  return val;
+}
+
+/* bin containing the element of a rank at a tail, namely the keys whose
+ * upper depth bits are prefix, narrowed by a digit of
+ * PLOTINC_RANGE_HISTOGRAM_BITS bits in each pass. The first digit consists
+ * of the sign and exponent, so the first histogram is log-spaced. */
+typedef struct{
+  uint64_t prefix;
+  int depth;
+  long rank; /* of the element in the bin */
+  bool flag_active;
+} _plotincRangeTail;
+
+/* bits of the next digit of a bin. */
+static int _plotincRangeTailBits(const _plotincRangeTail *tail)
+{
+  return 64 - tail->depth < PLOTINC_RANGE_HISTOGRAM_BITS ? 64 - tail->depth : PLOTINC_RANGE_HISTOGRAM_BITS;
+}
+
+/* the smallest and largest numbers in a bin, clamped to a range. */
+static double _plotincRangeTailMin(const _plotincRangeTail *tail, double min)
+{
+  return fmax( _plotincOrderedVal( tail->depth > 0 ? tail->prefix << ( 64 - tail->depth ) : 0 ), min );
+}
+
+static double _plotincRangeTailMax(const _plotincRangeTail *tail, double max)
+{
+  return fmin( _plotincOrderedVal( tail->depth < 64 ?
+    ( tail->depth > 0 ? tail->prefix << ( 64 - tail->depth ) : 0 ) | ~0ULL >> tail->depth : tail->prefix ), max );
+}
+
+/* scan of one or two columns to find their ranges, split into contiguous jobs.
+ * The first pass finds the minima and maxima, and also counts elements in
+ * histograms to clip tails, which the following passes refine in the bins
+ * at the tails only. */
+typedef struct{
+  const plotincColumn *column[2];
+  int column_num;
+  int size;
+  int job_num;
+  bool flag_minmax;
+  bool flag_histogram;
+  double min[2], max[2];
+  double *job_min, *job_max;  /* [job][column] */
+  _plotincRangeTail tail[2][2]; /* [column][lower/upper] */
+  long *histogram;            /* [job][column][lower/upper][bin] */
+} _plotincRangeScan;
+
+/* whether the upper tail of a column is in the same bin as the lower one,
+ * which is counted only in the histogram of the lower one. */
+static bool _plotincRangeScanShared(const _plotincRangeScan *scan, int c, int t)
+{
+  return t == 1 && scan->tail[c][0].flag_active &&
+    scan->tail[c][0].depth == scan->tail[c][1].depth && scan->tail[c][0].prefix == scan->tail[c][1].prefix;
+}
+
+static void _plotincRangeScanJob(void *arg, int i)
+{
+  _plotincRangeScan *scan = arg;
+  _plotincRangeTail *tail;
+  double buf[PLOTINC_TRANSFORM_CHUNK_SIZE];
+  const double *chunk;
+  double cmin, cmax;
+  uint64_t key;
+  long *histogram;
+  int begin, end, c, t, j, k, n, shift, mask;
+
+  begin = (long)scan->size * i / scan->job_num;
+  end = (long)scan->size * ( i + 1 ) / scan->job_num;
+  if( scan->flag_minmax )
+    for( c=0; c<scan->column_num; c++ ){
+      scan->job_min[i*2+c] = HUGE_VAL;
+      scan->job_max[i*2+c] =-HUGE_VAL;
+    }
+  /* columns are fused chunk by chunk, so that interleaved data are read once */
+  for( j=begin; j<end; j+=n ){
+    n = end - j < PLOTINC_TRANSFORM_CHUNK_SIZE ? end - j : PLOTINC_TRANSFORM_CHUNK_SIZE;
+    for( c=0; c<scan->column_num; c++ ){
+      chunk = _plotincColumnChunk( scan->column[c], j, n, buf );
+      if( scan->flag_minmax ){
+        _plotincMinMax( chunk, n, &cmin, &cmax );
+        if( cmin < scan->job_min[i*2+c] ) scan->job_min[i*2+c] = cmin;
+        if( cmax > scan->job_max[i*2+c] ) scan->job_max[i*2+c] = cmax;
+      }
+      if( !scan->flag_histogram ) continue;
+      for( t=0; t<2; t++ ){
+        tail = &scan->tail[c][t];
+        if( !tail->flag_active || _plotincRangeScanShared( scan, c, t ) ) continue;
+        histogram = scan->histogram + ( ( i*2 + c )*2 + t ) * PLOTINC_RANGE_HISTOGRAM_SIZE;
+        shift = 64 - tail->depth - _plotincRangeTailBits( tail );
+        mask = ( 1 << _plotincRangeTailBits( tail ) ) - 1;
+        for( k=0; k<n; k++ ){
+          if( chunk[k] != chunk[k] ) continue; /* NaN */
+          key = _plotincOrderedKey( chunk[k] );
+          if( tail->depth > 0 && key >> ( 64 - tail->depth ) != tail->prefix ) continue;
+          histogram[( key >> shift ) & mask]++;
+        }
+      }
+    }
+  }
+}
+
+/* narrow the bins at the tails of a column to the digits at which the
+ * counts accumulated reach their ranks. Ranks are set in the first pass,
+ * where the fraction of elements are clipped at each tail. A tail is settled
+ * when its bin gets narrower than the range kept by PLOTINC_RANGE_CLIP_BIN_NUM. */
+static void _plotincRangeScanSelect(_plotincRangeScan *scan, int c, double fraction, long count[2][PLOTINC_RANGE_HISTOGRAM_SIZE])
+{
+  _plotincRangeTail *tail;
+  long total, clip, sum;
+  double lower, upper;
+  int i, t, k, bits;
+
+  for( t=0; t<2; t++ ){
+    memset( count[t], 0, sizeof(long)*PLOTINC_RANGE_HISTOGRAM_SIZE );
+    if( !scan->tail[c][t].flag_active ) continue;
+    for( i=0; i<scan->job_num; i++ )
+      for( k=0; k<PLOTINC_RANGE_HISTOGRAM_SIZE; k++ )
+        count[t][k] += scan->histogram[( ( i*2 + c )*2 + ( _plotincRangeScanShared( scan, c, t ) ? 0 : t ) ) * PLOTINC_RANGE_HISTOGRAM_SIZE + k];
+  }
+  if( scan->tail[c][0].depth == 0 ){
+    for( total=0, k=0; k<PLOTINC_RANGE_HISTOGRAM_SIZE; k++ ) total += count[0][k];
+    if( total == 0 ){
+      scan->tail[c][0].flag_active = scan->tail[c][1].flag_active = false;
+      return;
+    }
+    clip = fraction * total;
+    scan->tail[c][0].rank = clip;
+    scan->tail[c][1].rank = total - 1 - clip > clip ? total - 1 - clip : clip;
+  }
+  for( t=0; t<2; t++ ){
+    tail = &scan->tail[c][t];
+    if( !tail->flag_active ) continue;
+    bits = _plotincRangeTailBits( tail );
+    for( sum=0, k=0; k<( 1<<bits )-1 && sum + count[t][k] <= tail->rank; k++ )
+      sum += count[t][k];
+    tail->rank -= sum;
+    tail->prefix = ( tail->depth > 0 ? tail->prefix << bits : 0 ) | k;
+    tail->depth += bits;
+  }
+  lower = _plotincRangeTailMin( &scan->tail[c][0], scan->min[c] );
+  upper = _plotincRangeTailMax( &scan->tail[c][1], scan->max[c] );
+  for( t=0; t<2; t++ ){
+    tail = &scan->tail[c][t];
+    tail->flag_active = tail->depth < 64 &&
+      _plotincRangeTailMax( tail, scan->max[c] ) - _plotincRangeTailMin( tail, scan->min[c] ) > ( upper - lower ) / PLOTINC_RANGE_CLIP_BIN_NUM;
+  }
+}
+
+/* find the ranges of the first size elements of one or two columns on the
+ * threads of a frame, where NaNs are ignored and tails are clipped as set to
+ * the frame. A column without numbers has the minimum above the maximum.
+ * Tails are clipped in at most 64/PLOTINC_RANGE_HISTOGRAM_BITS+1 passes
+ * including the first one, and mostly in two or three. */
+static bool _plotincFrameScanRange(const plotincFrame *frame, const plotincColumn *column0, const plotincColumn *column1, int size, double min[], double max[])
+{
+  _plotincRangeScan scan;
+  long (* count)[PLOTINC_RANGE_HISTOGRAM_SIZE] = NULL;
+  int thread_num, c, i;
+  bool flag_active, ret = false;
+
+  scan.column[0] = column0;
+  scan.column[1] = column1;
+  scan.column_num = column1 ? 2 : 1;
+  scan.size = size;
+  thread_num = _plotincFrameThreadNum( frame );
+  scan.job_num = size / PLOTINC_RANGE_JOB_MINSIZE + 1;
+  if( scan.job_num > thread_num ) scan.job_num = thread_num;
+  scan.flag_minmax = true;
+  scan.flag_histogram = false;
+  scan.histogram = NULL;
+  scan.job_min = malloc( sizeof(double)*2*scan.job_num );
+  scan.job_max = malloc( sizeof(double)*2*scan.job_num );
+  if( !scan.job_min || !scan.job_max ){
+    fprintf( stderr, "cannot allocate memory to find ranges.\n" );
+    goto TERMINATE;
+  }
+  if( frame->range_clip > 0 ){
+    scan.histogram = malloc( sizeof(long) * scan.job_num * 4 * PLOTINC_RANGE_HISTOGRAM_SIZE );
+    count = malloc( sizeof(long) * 2 * PLOTINC_RANGE_HISTOGRAM_SIZE );
+    if( !scan.histogram || !count )
+      fprintf( stderr, "cannot allocate memory for histograms, tails not clipped.\n" );
+    else
+      scan.flag_histogram = true;
+  }
+  for( c=0; c<2; c++ ){
+    scan.tail[c][0].prefix = scan.tail[c][1].prefix = 0;
+    scan.tail[c][0].depth = scan.tail[c][1].depth = 0;
+    scan.tail[c][0].flag_active = scan.tail[c][1].flag_active = true;
+  }
+  do{
+    if( scan.flag_histogram )
+      memset( scan.histogram, 0, sizeof(long) * scan.job_num * 4 * PLOTINC_RANGE_HISTOGRAM_SIZE );
+    _plotincParallel( thread_num, scan.job_num, _plotincRangeScanJob, &scan );
+    if( scan.flag_minmax ){
+      for( c=0; c<scan.column_num; c++ ){
+        scan.min[c] = HUGE_VAL;
+        scan.max[c] =-HUGE_VAL;
+        for( i=0; i<scan.job_num; i++ ){
+          if( scan.job_min[i*2+c] < scan.min[c] ) scan.min[c] = scan.job_min[i*2+c];
+          if( scan.job_max[i*2+c] > scan.max[c] ) scan.max[c] = scan.job_max[i*2+c];
+        }
+      }
+      scan.flag_minmax = false;
+    }
+    if( !scan.flag_histogram ) break;
+    for( flag_active=false, c=0; c<scan.column_num; c++ ){
+      _plotincRangeScanSelect( &scan, c, frame->range_clip, count );
+      flag_active = flag_active || scan.tail[c][0].flag_active || scan.tail[c][1].flag_active;
+    }
+  } while( flag_active );
+  for( c=0; c<scan.column_num; c++ ){
+    if( scan.flag_histogram && scan.tail[c][0].depth > 0 ){
+      min[c] = _plotincRangeTailMin( &scan.tail[c][0], scan.min[c] );
+      max[c] = _plotincRangeTailMax( &scan.tail[c][1], scan.max[c] );
+    } else{
+      min[c] = scan.min[c];
+      max[c] = scan.max[c];
+    }
+  }
+  ret = true;
+ TERMINATE:
+  free( scan.job_min );
+  free( scan.job_max );
+  free( scan.histogram );
+  free( count );
+  return ret;
+}
+
+/* attach a pyramid to a frame, which is looked up instead of scanning data
+ * when the y-range is set based on the same data. A null pointer detaches it. */
+void plotincFrameSetPyramid(plotincFrame *frame, const plotincPyramid *pyramid)
+{
+  frame->pyramid = pyramid;
+}
+
+/* whether the pyramid attached to a frame covers 1-dimensional data in a
+ * column, which is not usable to clip tails of the data. */
+static bool _plotincFramePyramidOf(const plotincFrame *frame, const plotincColumn *column)
+{
+  const plotincColumn *pcolumn;
+
+  if( !frame->pyramid || frame->range_clip > 0 ) return false;
+  pcolumn = &frame->pyramid->column;
+  return pcolumn->data == column->data && pcolumn->type == column->type &&
+         pcolumn->stride == column->stride && column->size <= pcolumn->size;
+}
+
+/* set y-range of a frame based on 1-dimensional data in a column.
+ * The pyramid attached to the frame is looked up instead if it covers the data. */
+void plotincFrameSetRangeByColumn1D(plotincFrame *frame, const plotincColumn *column)
+{
+  double ymin, ymax;
+
+  if( column->size <= 0 ) return;
+  if( _plotincFramePyramidOf( frame, column ) ){
+    plotincFrameSetRangeByPyramid( frame, frame->pyramid, 0, column->size );
+    return;
+  }
+  plotincFrameSetXRange( frame, 0, column->size-1 );
+  if( _plotincFrameScanRange( frame, column, NULL, column->size, &ymin, &ymax ) && ymax > ymin )
+    plotincFrameSetYRange( frame, ymin, ymax );
+}
+
+/* set x- and y-ranges of a frame based on 2-dimensional data in columns,
+ * which are scanned in a single pass. */
+void plotincFrameSetRangeByColumn2D(plotincFrame *frame, const plotincColumn *xcolumn, const plotincColumn *ycolumn)
+{
+  double min[2], max[2];
+  int size;
+
+  if( ( size = xcolumn->size < ycolumn->size ? xcolumn->size : ycolumn->size ) <= 0 ) return;
+  if( !_plotincFrameScanRange( frame, xcolumn, ycolumn, size, min, max ) ) return;
+  if( max[0] > min[0] )
+    plotincFrameSetXRange( frame, min[0], max[0] );
+  if( max[1] > min[1] )
+    plotincFrameSetYRange( frame, min[1], max[1] );
+}
+
+/* set y-range of a frame based on 1-dimensional data. */
+void plotincFrameSetRangeByData1D(plotincFrame *frame, const double data[], int size)
+{
+  plotincColumn column;
+
+  plotincColumnAssign( &column, PLOTINC_DATA_DOUBLE, data, 0, size );
+  plotincFrameSetRangeByColumn1D( frame, &column );
+}
+
+/* set x- and y-ranges of a frame based on 2-dimensional data. */
+void plotincFrameSetRangeByData2D(plotincFrame *frame, const double xdata[], const double ydata[], int size)
+{
+  plotincColumn xcolumn, ycolumn;
+
+  plotincColumnAssign( &xcolumn, PLOTINC_DATA_DOUBLE, xdata, 0, size );
+  plotincColumnAssign( &ycolumn, PLOTINC_DATA_DOUBLE, ydata, 0, size );
+  plotincFrameSetRangeByColumn2D( frame, &xcolumn, &ycolumn );
+}
+
+/* set y-range of a frame based on 1-dimensional data of a type placed at a byte stride. */
+void plotincFrameSetRangeByTypedData1D(plotincFrame *frame, plotincDataType type, const void *data, size_t stride, int size)
+{
+  plotincColumn column;
+
+  plotincColumnAssign( &column, type, data, stride, size );
+  plotincFrameSetRangeByColumn1D( frame, &column );
+}
+
+/* set x- and y-ranges of a frame based on 2-dimensional data of types placed at byte strides. */
+void plotincFrameSetRangeByTypedData2D(plotincFrame *frame, plotincDataType xtype, const void *xdata, size_t xstride, plotincDataType ytype, const void *ydata, size_t ystride, int size)
+{
+  plotincColumn xcolumn, ycolumn;
+
+  plotincColumnAssign( &xcolumn, xtype, xdata, xstride, size );
+  plotincColumnAssign( &ycolumn, ytype, ydata, ystride, size );
+  plotincFrameSetRangeByColumn2D( frame, &xcolumn, &ycolumn );
+}
+
+/* x-value of the i-th sample, which is the index from index0 for 1-dimensional data. */
+static double _plotincDataX(const plotincColumn *xcolumn, int i, int index0)
+{
+  return xcolumn ? _plotincColumnValue( xcolumn, i ) : index0 + i;
+}
+
+/* add vertices of data in columns to a path through batch transforms.
+ * x-values are indices from index0 if xcolumn is null. */
+static void _plotincFramePathColumn(const plotincFrame *frame, _plotincPath *path, const plotincColumn *xcolumn, const plotincColumn *ycolumn, int size, int index0)
+{
+  plotincTransform xt, yt;
+  double index[PLOTINC_TRANSFORM_CHUNK_SIZE];
+  int px[PLOTINC_TRANSFORM_CHUNK_SIZE], py[PLOTINC_TRANSFORM_CHUNK_SIZE];
+  int i, j, n;
+
+  xt = plotincFrameXTransform( frame );
+  yt = plotincFrameYTransform( frame );
+  for( i=0; i<size; i+=n ){
+    n = size - i < PLOTINC_TRANSFORM_CHUNK_SIZE ? size - i : PLOTINC_TRANSFORM_CHUNK_SIZE;
+    if( xcolumn )
+      _plotincColumnTransformToInt( &xt, xcolumn, i, n, px );
+    else{
+      for( j=0; j<n; j++ ) index[j] = index0 + i + j;
+      plotincTransformDoubleArrayToInt( &xt, index, px, n );
+    }
+    _plotincColumnTransformToInt( &yt, ycolumn, i, n, py );
+    for( j=0; j<n; j++ )
+      _plotincPathAddVertex( path, px[j], py[j] );
+  }
+}
+
+/* add vertices of data to a path through batch transforms.
+ * x-values are indices from index0 if xdata is null. */
+static void _plotincFramePathData(const plotincFrame *frame, _plotincPath *path, const double xdata[], const double ydata[], int size, int index0)
+{
+  plotincColumn xcolumn, ycolumn;
+
+  plotincColumnAssign( &xcolumn, PLOTINC_DATA_DOUBLE, xdata, 0, size );
+  plotincColumnAssign( &ycolumn, PLOTINC_DATA_DOUBLE, ydata, 0, size );
+  _plotincFramePathColumn( frame, path, xdata ? &xcolumn : NULL, &ycolumn, size, index0 );
+}
+
+/* plot data on a frame through all samples or M4 decimation. */
+static void _plotincFramePlotDataPath(const plotincFrame *frame, cairo_t *cairo, const plotincColumn *xcolumn, const plotincColumn *ycolumn, int size, int index0, plotincDecimation decimation)
+{
+  _plotincPath path;
+
+  _plotincPathInit( &path, frame, cairo, decimation );
+  _plotincFramePathColumn( frame, &path, xcolumn, ycolumn, size, index0 );
+  _plotincPathStroke( &path );
+}
+
+/* plot data on a frame through largest-triangle-three-buckets decimation. */
+static void _plotincFramePlotDataLTTB(const plotincFrame *frame, cairo_t *cairo, const plotincColumn *xcolumn, const plotincColumn *ycolumn, int size, int index0)
+{
+  plotincTransform xt, yt;
+  _plotincPath path;
+  int bucket_num, b, i, i_begin, i_end, i_next_end, a, a_next;
+  double bucket_width, ax, ay, cx, cy, x, y, area, area_max;
+
+  bucket_num = frame->plot_width * PLOTINC_LTTB_BUCKETS_PER_PIXEL;
+  if( size <= bucket_num + 2 ){
+    _plotincFramePlotDataPath( frame, cairo, xcolumn, ycolumn, size, index0, PLOTINC_DECIMATION_NONE );
+    return;
+  }
+  xt = plotincFrameXTransform( frame );
+  yt = plotincFrameYTransform( frame );
+  _plotincPathInit( &path, frame, cairo, PLOTINC_DECIMATION_NONE );
+  /* the first and the last samples are always kept; the rest are split into buckets */
+  bucket_width = (double)( size - 2 ) / bucket_num;
+  _plotincPathAddVertex( &path, _plotincTransformApplyInt( &xt, _plotincDataX( xcolumn, 0, index0 ) ), _plotincTransformApplyInt( &yt, _plotincColumnValue( ycolumn, 0 ) ) );
+  for( a=0, b=0; b<bucket_num; b++, a=a_next ){
+    i_begin = 1 + (int)( b * bucket_width );
+    i_end   = 1 + (int)( ( b + 1 ) * bucket_width );
+    i_next_end = b + 1 < bucket_num ? 1 + (int)( ( b + 2 ) * bucket_width ) : size;
+    /* average of the next bucket */
+    for( cx=cy=0, i=i_end; i<i_next_end; i++ ){
+      cx += _plotincTransformApply( &xt, _plotincDataX( xcolumn, i, index0 ) );
+      cy += _plotincTransformApply( &yt, _plotincColumnValue( ycolumn, i ) );
+    }
+    cx /= i_next_end - i_end;
+    cy /= i_next_end - i_end;
+    ax = _plotincTransformApply( &xt, _plotincDataX( xcolumn, a, index0 ) );
+    ay = _plotincTransformApply( &yt, _plotincColumnValue( ycolumn, a ) );
+    /* sample forming the largest triangle with the previous pick and the next average */
+    for( a_next=i_begin, area_max=-1, i=i_begin; i<i_end; i++ ){
+      x = _plotincTransformApply( &xt, _plotincDataX( xcolumn, i, index0 ) );
+      y = _plotincTransformApply( &yt, _plotincColumnValue( ycolumn, i ) );
+      if( ( area = fabs( ( ax - cx ) * ( y - ay ) - ( ax - x ) * ( cy - ay ) ) ) > area_max ){
+        area_max = area;
+        a_next = i;
+      }
+    }
+    _plotincPathAddVertex( &path, _plotincTransformApplyInt( &xt, _plotincDataX( xcolumn, a_next, index0 ) ), _plotincTransformApplyInt( &yt, _plotincColumnValue( ycolumn, a_next ) ) );
+  }
+  _plotincPathAddVertex( &path, _plotincTransformApplyInt( &xt, _plotincDataX( xcolumn, size-1, index0 ) ), _plotincTransformApplyInt( &yt, _plotincColumnValue( ycolumn, size-1 ) ) );
+  _plotincPathStroke( &path );
+}
+
+/* plot data in columns on a frame. Samples of 1-dimensional data are
+ * narrowed down to those in the x-range and the nearest ones outside it. */
+static void _plotincFramePlotColumn(const plotincFrame *frame, cairo_t *cairo, const plotincColumn *xcolumn, const plotincColumn *ycolumn, int size, plotincDecimation decimation)
+{
+  plotincColumn visible;
+  double xmin, xmax;
+  int index0 = 0;
+
+  if( size <= 0 ) return;
+  if( !xcolumn ){
+    xmin = floor( fmin( frame->xaxis.range_min, frame->xaxis.range_max ) );
+    xmax = ceil( fmax( frame->xaxis.range_min, frame->xaxis.range_max ) ) + 1;
+    if( !( xmax > 0 && xmin < size ) ) return;
+    if( xmin > 0 ) index0 = xmin;
+    if( xmax < size ) size = xmax;
+    size -= index0;
+    visible = *ycolumn;
+    visible.data = (const char *)ycolumn->data + (size_t)index0 * ycolumn->stride;
+    visible.size = size;
+    ycolumn = &visible;
+  }
+  if( decimation == PLOTINC_DECIMATION_LTTB )
+    _plotincFramePlotDataLTTB( frame, cairo, xcolumn, ycolumn, size, index0 );
+  else
+    _plotincFramePlotDataPath( frame, cairo, xcolumn, ycolumn, size, index0, decimation );
+}
+
+static void _plotincFramePlotData(const plotincFrame *frame, cairo_t *cairo, const double xdata[], const double ydata[], int size, plotincDecimation decimation)
+{
+  plotincColumn xcolumn, ycolumn;
+
+  plotincColumnAssign( &xcolumn, PLOTINC_DATA_DOUBLE, xdata, 0, size );
+  plotincColumnAssign( &ycolumn, PLOTINC_DATA_DOUBLE, ydata, 0, size );
+  _plotincFramePlotColumn( frame, cairo, xdata ? &xcolumn : NULL, &ycolumn, size, decimation );
+}
+
+/* plot 1-dimensional data on a frame. */
+void plotincFramePlotData1D(const plotincFrame *frame, cairo_t *cairo, const double data[], int size)
+{
+  _plotincFramePlotData( frame, cairo, NULL, data, size, frame->decimation );
+}
+
+/* plot 1-dimensional data on a frame with a specified decimation method. */
+void plotincFramePlotData1DDecimated(const plotincFrame *frame, cairo_t *cairo, const double data[], int size, plotincDecimation decimation)
+{
+  _plotincFramePlotData( frame, cairo, NULL, data, size, decimation );
+}
+
+/* plot 2-dimensional data on a frame. */
+void plotincFramePlotData2D(const plotincFrame *frame, cairo_t *cairo, const double xdata[], const double ydata[], int size)
+{
+  _plotincFramePlotData( frame, cairo, xdata, ydata, size, frame->decimation );
+}
+
+/* plot 2-dimensional data on a frame with a specified decimation method. */
+void plotincFramePlotData2DDecimated(const plotincFrame *frame, cairo_t *cairo, const double xdata[], const double ydata[], int size, plotincDecimation decimation)
+{
+  _plotincFramePlotData( frame, cairo, xdata, ydata, size, decimation );
+}
+
+/* plot 1-dimensional data in a column on a frame. */
+void plotincFramePlotColumn1D(const plotincFrame *frame, cairo_t *cairo, const plotincColumn *column)
+{
+  _plotincFramePlotColumn( frame, cairo, NULL, column, column->size, frame->decimation );
+}
+
+/* plot 2-dimensional data in columns on a frame. */
+void plotincFramePlotColumn2D(const plotincFrame *frame, cairo_t *cairo, const plotincColumn *xcolumn, const plotincColumn *ycolumn)
+{
+  _plotincFramePlotColumn( frame, cairo, xcolumn, ycolumn,
+    xcolumn->size < ycolumn->size ? xcolumn->size : ycolumn->size, frame->decimation );
+}
+
+/* plot 1-dimensional data of a type placed at a byte stride on a frame. */
+void plotincFramePlotTypedData1D(const plotincFrame *frame, cairo_t *cairo, plotincDataType type, const void *data, size_t stride, int size)
+{
+  plotincColumn column;
+
+  plotincColumnAssign( &column, type, data, stride, size );
+  plotincFramePlotColumn1D( frame, cairo, &column );
+}
+
+/* plot 2-dimensional data of types placed at byte strides on a frame. */
+void plotincFramePlotTypedData2D(const plotincFrame *frame, cairo_t *cairo, plotincDataType xtype, const void *xdata, size_t xstride, plotincDataType ytype, const void *ydata, size_t ystride, int size)
+{
+  plotincColumn xcolumn, ycolumn;
+
+  plotincColumnAssign( &xcolumn, xtype, xdata, xstride, size );
+  plotincColumnAssign( &ycolumn, ytype, ydata, ystride, size );
+  plotincFramePlotColumn2D( frame, cairo, &xcolumn, &ycolumn );
+}
+
+/* set x-range of a frame to indices from index from to index to (exclusive)
+ * of data in a pyramid, and y-range to the minimum and maximum in the range. */
+void plotincFrameSetRangeByPyramid(plotincFrame *frame, const plotincPyramid *pyramid, int from, int to)
+{
+  double ymin, ymax;
+
+  if( from < 0 ) from = 0;
+  if( to > pyramid->column.size ) to = pyramid->column.size;
+  if( to <= from ) return;
+  plotincFrameSetXRange( frame, from, to-1 );
+  if( plotincPyramidMinMax( pyramid, from, to, &ymin, &ymax ) && ymax > ymin )
+    plotincFrameSetYRange( frame, ymin, ymax );
+}
+
+/* plot 1-dimensional data in a pyramid on a frame.
+ * Data are drawn through the minima and maxima of blocks of the largest size
+ * not exceeding samples per pixel column, which are M4-decimated, so that the
+ * cost is proportional to the plot width at any x-range. Samples are drawn
+ * directly with the decimation of the frame if they are fewer than the
+ * smallest blocks. */
+void plotincFramePlotPyramid(const plotincFrame *frame, cairo_t *cairo, const plotincPyramid *pyramid)
+{
+  plotincTransform xt, yt;
+  const plotincPyramidLevel *level;
+  _plotincPath path;
+  double xmin, xmax, samples, y_last, y0, y1;
+  int i_begin, i_end, k, j, j_end, block, x;
+
+  if( pyramid->column.size <= 0 ) return;
+  xmin = floor( fmin( frame->xaxis.range_min, frame->xaxis.range_max ) );
+  xmax = ceil( fmax( frame->xaxis.range_min, frame->xaxis.range_max ) ) + 1;
+  if( !( xmax > 0 && xmin < pyramid->column.size ) ) return;
+  i_begin = xmin > 0 ? xmin : 0;
+  i_end = xmax < pyramid->column.size ? xmax : pyramid->column.size;
+  samples = (double)( i_end - i_begin ) / abs( frame->plot_width );
+  for( k=0; k+1<pyramid->level_num && ( 2L << ( PLOTINC_PYRAMID_BLOCK_SHIFT + k ) ) <= samples; k++ );
+  if( pyramid->level_num == 0 || ( 1L << PLOTINC_PYRAMID_BLOCK_SHIFT ) > samples ){
+    _plotincFramePlotColumn( frame, cairo, NULL, &pyramid->column, pyramid->column.size, frame->decimation );
+    return;
+  }
+  level = &pyramid->level[k];
+  block = 1 << ( PLOTINC_PYRAMID_BLOCK_SHIFT + k );
+  xt = plotincFrameXTransform( frame );
+  yt = plotincFrameYTransform( frame );
+  _plotincPathInit( &path, frame, cairo, PLOTINC_DECIMATION_M4 );
+  j_end = ( i_end + block - 1 ) / block;
+  for( y_last=HUGE_VAL, j=i_begin/block; j<j_end; j++ ){
+    if( level->min[j] > level->max[j] ) continue; /* NaNs only */
+    /* the center of a block, or of the remainder of the last one */
+    x = _plotincTransformApplyInt( &xt, j * (double)block + 0.5 * ( ( j+1 < level->size ? block : pyramid->column.size - j * (double)block ) - 1 ) );
+    y0 = _plotincTransformApplyInt( &yt, level->min[j] );
+    y1 = _plotincTransformApplyInt( &yt, level->max[j] );
+    /* continue from the nearer extremum to the last vertex */
+    if( fabs( y1 - y_last ) < fabs( y0 - y_last ) ){
+      _plotincPathAddVertex( &path, x, y1 );
+      _plotincPathAddVertex( &path, x, y0 );
+      y_last = y0;
+    } else{
+      _plotincPathAddVertex( &path, x, y0 );
+      _plotincPathAddVertex( &path, x, y1 );
+      y_last = y1;
+    }
+  }
+  _plotincPathStroke( &path );
+}
+
+/* paint an image surface placed at device pixels on a frame, clipped to the plot region. */
+static void _plotincFramePaintImage(const plotincFrame *frame, cairo_t *cairo, cairo_surface_t *surface, int ox, int oy)
+{
+  cairo_save( cairo );
+  cairo_rectangle( cairo, frame->plot_ox, frame->plot_oy, frame->plot_width, frame->plot_height );
+  cairo_clip( cairo );
+  cairo_set_source_surface( cairo, surface, ox, oy );
+  cairo_pattern_set_filter( cairo_get_source( cairo ), CAIRO_FILTER_NEAREST );
+  cairo_paint( cairo );
+  cairo_restore( cairo );
+}
+
+/* matrix resampled on pixels of an image in parallel by blocks of rows. */
+typedef struct{
+  plotincDataType type;
+  const char *data;
+  size_t elem_size;
+  int rows, cols;
+  const plotincColormap *colormap;
+  plotincInterpolation interpolation;
+  /* source column and its weight for each pixel column; the source row of
+   * the j-th pixel row is v0 + dv * j in cells */
+  int *col0, *col1;
+  double *wx;
+  double v0, dv;
+  /* destination */
+  unsigned char *pixels;
+  int stride;
+  int width, height;
+} _plotincImage;
+
+/* value of an element of a matrix. */
+static inline double _plotincImageValue(const _plotincImage *image, int row, int col)
+{
+  return _plotincDataValue( image->type, image->data + ( (size_t)row * image->cols + col ) * image->elem_size );
+}
+
+/* resample a block of rows of a matrix and map them through a colormap. */
+static void _plotincImageDrawRows(void *arg, int k)
+{
+  _plotincImage *image = arg;
+  double *line, v, fy, a, b;
+  int j, j_end, i, r0, r1;
+
+  if( !( line = malloc( sizeof(double)*image->width ) ) ) return;
+  j_end = ( k + 1 ) * PLOTINC_IMAGE_ROWS_PER_JOB;
+  if( j_end > image->height ) j_end = image->height;
+  for( j=k*PLOTINC_IMAGE_ROWS_PER_JOB; j<j_end; j++ ){
+    v = image->v0 + image->dv * j;
+    if( image->interpolation == PLOTINC_INTERPOLATION_BILINEAR ){
+      /* sample values are placed at centers of cells */
+      v -= 0.5;
+      r0 = floor( v );
+      fy = v - r0;
+      if( r0 < 0 ){ r0 = 0; fy = 0; }
+      if( r0 > image->rows - 1 ){ r0 = image->rows - 1; fy = 0; }
+      r1 = r0 < image->rows - 1 ? r0 + 1 : r0;
+      for( i=0; i<image->width; i++ ){
+        a = _plotincImageValue( image, r0, image->col0[i] );
+        a += ( _plotincImageValue( image, r0, image->col1[i] ) - a ) * image->wx[i];
+        b = _plotincImageValue( image, r1, image->col0[i] );
+        b += ( _plotincImageValue( image, r1, image->col1[i] ) - b ) * image->wx[i];
+        line[i] = a + ( b - a ) * fy;
+      }
+    } else{
+      r0 = floor( v );
+      if( r0 < 0 ) r0 = 0;
+      if( r0 > image->rows - 1 ) r0 = image->rows - 1;
+      for( i=0; i<image->width; i++ )
+        line[i] = _plotincImageValue( image, r0, image->col0[i] );
+    }
+    plotincColormapApply( image->colormap, line, (uint32_t *)( image->pixels + (size_t)j * image->stride ), image->width );
+  }
+  free( line );
+}
+
+/* plot a matrix of values as an image through a colormap on a frame.
+ * The matrix has rows x cols elements of a type in row-major order, and
+ * covers [xmin,xmax] x [ymin,ymax], where the first row is at ymin. It is
+ * resampled on device pixels in the plot region, divided into blocks of
+ * rows which are processed in parallel on threads of the canvas. */
+void plotincFramePlotImage(const plotincFrame *frame, cairo_t *cairo, plotincDataType type, const void *data, int rows, int cols, double xmin, double xmax, double ymin, double ymax, const plotincColormap *colormap, plotincInterpolation interpolation)
+{
+  plotincTransform xt, yt;
+  _plotincImage image;
+  cairo_surface_t *surface;
+  double x0, x1, y0, y1, u;
+  int ox, oy, i, c;
+
+  if( rows <= 0 || cols <= 0 || xmax == xmin || ymax == ymin ) return;
+  /* device region covered by the matrix in the plot region */
+  xt = plotincFrameXTransform( frame );
+  yt = plotincFrameYTransform( frame );
+  x0 = _plotincTransformApply( &xt, xmin ); x1 = _plotincTransformApply( &xt, xmax );
+  y0 = _plotincTransformApply( &yt, ymin ); y1 = _plotincTransformApply( &yt, ymax );
+  ox = floor( fmax( fmin( x0, x1 ), frame->plot_ox ) );
+  oy = floor( fmax( fmin( y0, y1 ), frame->plot_oy ) );
+  image.width  = ceil( fmin( fmax( x0, x1 ), frame->plot_ox + frame->plot_width ) ) - ox;
+  image.height = ceil( fmin( fmax( y0, y1 ), frame->plot_oy + frame->plot_height ) ) - oy;
+  if( image.width <= 0 || image.height <= 0 ) return;
+
+  surface = cairo_image_surface_create( CAIRO_FORMAT_ARGB32, image.width, image.height );
+  image.col0 = malloc( sizeof(int)*image.width );
+  image.col1 = malloc( sizeof(int)*image.width );
+  image.wx = malloc( sizeof(double)*image.width );
+  if( cairo_surface_status( surface ) != CAIRO_STATUS_SUCCESS || !image.col0 || !image.col1 || !image.wx ){
+    fprintf( stderr, "cannot allocate memory for an image.\n" );
+    goto TERMINATE;
+  }
+  image.type = type;
+  image.data = data;
+  image.elem_size = plotincDataTypeSize( type );
+  image.rows = rows;
+  image.cols = cols;
+  image.colormap = colormap;
+  image.interpolation = interpolation;
+  /* source cells at centers of pixels */
+  for( i=0; i<image.width; i++ ){
+    u = ( ( ox + i + 0.5 - xt.offset ) / xt.scale - xmin ) / ( xmax - xmin ) * cols;
+    if( interpolation == PLOTINC_INTERPOLATION_BILINEAR ){
+      u -= 0.5;
+      c = floor( u );
+      image.wx[i] = u - c;
+      if( c < 0 ){ c = 0; image.wx[i] = 0; }
+      if( c > cols - 1 ){ c = cols - 1; image.wx[i] = 0; }
+    } else{
+      c = floor( u );
+      if( c < 0 ) c = 0;
+      if( c > cols - 1 ) c = cols - 1;
+      image.wx[i] = 0;
+    }
+    image.col0[i] = c;
+    image.col1[i] = c < cols - 1 ? c + 1 : c;
+  }
+  image.v0 = ( ( oy + 0.5 - yt.offset ) / yt.scale - ymin ) / ( ymax - ymin ) * rows;
+  image.dv = 1 / yt.scale / ( ymax - ymin ) * rows;
+  image.pixels = cairo_image_surface_get_data( surface );
+  image.stride = cairo_image_surface_get_stride( surface );
+  cairo_surface_flush( surface );
+  _plotincParallel( _plotincFrameThreadNum( frame ),
+    ( image.height + PLOTINC_IMAGE_ROWS_PER_JOB - 1 ) / PLOTINC_IMAGE_ROWS_PER_JOB, _plotincImageDrawRows, &image );
+  cairo_surface_mark_dirty( surface );
+  _plotincFramePaintImage( frame, cairo, surface, ox, oy );
+ TERMINATE:
+  cairo_surface_destroy( surface );
+  free( image.col0 );
+  free( image.col1 );
+  free( image.wx );
+}
+
+/* samples counted on pixels of the plot region of a frame in parallel.
+ * Each job counts a part of samples on its own grid, and the grids are
+ * summed up into the first one afterward. */
+typedef struct{
+  const plotincFrame *frame;
+  const plotincColumn *xcolumn, *ycolumn;
+  int size;
+  int job_num;
+  uint32_t **grid;
+} _plotincDensity;
+
+/* count a part of samples on a grid. */
+static void _plotincDensityCount(void *arg, int k)
+{
+  _plotincDensity *density = arg;
+  const plotincFrame *frame = density->frame;
+  plotincTransform xt, yt;
+  uint32_t *grid = density->grid[k];
+  int px[PLOTINC_TRANSFORM_CHUNK_SIZE], py[PLOTINC_TRANSFORM_CHUNK_SIZE];
+  int i, i_end, j, n, x, y;
+
+  xt = plotincFrameXTransform( frame );
+  yt = plotincFrameYTransform( frame );
+  i_end = (long)density->size * ( k + 1 ) / density->job_num;
+  for( i=(long)density->size * k / density->job_num; i<i_end; i+=n ){
+    n = i_end - i < PLOTINC_TRANSFORM_CHUNK_SIZE ? i_end - i : PLOTINC_TRANSFORM_CHUNK_SIZE;
+    _plotincColumnTransformToInt( &xt, density->xcolumn, i, n, px );
+    _plotincColumnTransformToInt( &yt, density->ycolumn, i, n, py );
+    for( j=0; j<n; j++ ){
+      x = px[j] - frame->plot_ox;
+      y = py[j] - frame->plot_oy;
+      if( x >= 0 && x < frame->plot_width && y >= 0 && y < frame->plot_height )
+        grid[y*frame->plot_width+x]++;
+    }
+  }
+}
+
+/* sum up a block of rows of grids into the first one. */
+static void _plotincDensityMerge(void *arg, int k)
+{
+  _plotincDensity *density = arg;
+  int i, i_begin, i_end, g;
+
+  i_begin = k * PLOTINC_IMAGE_ROWS_PER_JOB * density->frame->plot_width;
+  i_end = i_begin + PLOTINC_IMAGE_ROWS_PER_JOB * density->frame->plot_width;
+  if( i_end > density->frame->plot_width * density->frame->plot_height )
+    i_end = density->frame->plot_width * density->frame->plot_height;
+  for( g=1; g<density->job_num; g++ )
+    for( i=i_begin; i<i_end; i++ ) density->grid[0][i] += density->grid[g][i];
+}
+
+/* plot density of 2-dimensional data in columns on a frame as an image.
+ * Samples are counted on device pixels of the plot region, and the counts
+ * are mapped through a colormap in linear or logarithmic scale from zero to
+ * the maximum count, where pixels without samples are left transparent. */
+void plotincFramePlotDensityColumn2D(const plotincFrame *frame, cairo_t *cairo, const plotincColumn *xcolumn, const plotincColumn *ycolumn, const plotincColormap *colormap, plotincDensityScale scale)
+{
+  _plotincDensity density;
+  plotincColormap cmap;
+  cairo_surface_t *surface;
+  unsigned char *pixels;
+  double *line;
+  uint32_t count, count_max;
+  int stride, num, i, j, k;
+
+  if( frame->plot_width <= 0 || frame->plot_height <= 0 ) return;
+  density.frame = frame;
+  density.xcolumn = xcolumn;
+  density.ycolumn = ycolumn;
+  if( ( density.size = xcolumn->size < ycolumn->size ? xcolumn->size : ycolumn->size ) <= 0 ) return;
+  density.job_num = _plotincFrameThreadNum( frame );
+  if( density.job_num > density.size ) density.job_num = density.size;
+  num = frame->plot_width * frame->plot_height;
+  line = malloc( sizeof(double)*frame->plot_width );
+  surface = cairo_image_surface_create( CAIRO_FORMAT_ARGB32, frame->plot_width, frame->plot_height );
+  if( !( density.grid = calloc( density.job_num, sizeof(uint32_t *) ) ) || !line ||
+      cairo_surface_status( surface ) != CAIRO_STATUS_SUCCESS ){
+    fprintf( stderr, "cannot allocate memory for a density plot.\n" );
+    goto TERMINATE;
+  }
+  for( k=0; k<density.job_num; k++ )
+    if( !( density.grid[k] = calloc( num, sizeof(uint32_t) ) ) ){
+      fprintf( stderr, "cannot allocate memory for a density plot.\n" );
+      goto TERMINATE;
+    }
+  _plotincParallel( density.job_num, density.job_num, _plotincDensityCount, &density );
+  if( density.job_num > 1 )
+    _plotincParallel( density.job_num,
+      ( frame->plot_height + PLOTINC_IMAGE_ROWS_PER_JOB - 1 ) / PLOTINC_IMAGE_ROWS_PER_JOB, _plotincDensityMerge, &density );
+  for( count_max=0, i=0; i<num; i++ )
+    if( density.grid[0][i] > count_max ) count_max = density.grid[0][i];
+  /* map counts to colors */
+  cmap = *colormap;
+  plotincColormapSetRange( &cmap, 0, scale == PLOTINC_DENSITY_LOG ? log( count_max ) : count_max );
+  pixels = cairo_image_surface_get_data( surface );
+  stride = cairo_image_surface_get_stride( surface );
+  cairo_surface_flush( surface );
+  for( j=0; j<frame->plot_height; j++ ){
+    for( i=0; i<frame->plot_width; i++ ){
+      count = density.grid[0][j*frame->plot_width+i];
+      line[i] = count == 0 ? NAN : scale == PLOTINC_DENSITY_LOG ? log( count ) : count;
+    }
+    plotincColormapApply( &cmap, line, (uint32_t *)( pixels + (size_t)j * stride ), frame->plot_width );
+  }
+  cairo_surface_mark_dirty( surface );
+  _plotincFramePaintImage( frame, cairo, surface, frame->plot_ox, frame->plot_oy );
+ TERMINATE:
+  cairo_surface_destroy( surface );
+  if( density.grid )
+    for( k=0; k<density.job_num; k++ ) free( density.grid[k] );
+  free( density.grid );
+  free( line );
+}
+
+/* plot density of 2-dimensional data on a frame as an image. */
+void plotincFramePlotDensity2D(const plotincFrame *frame, cairo_t *cairo, const double xdata[], const double ydata[], int size, const plotincColormap *colormap, plotincDensityScale scale)
+{
+  plotincColumn xcolumn, ycolumn;
+
+  plotincColumnAssign( &xcolumn, PLOTINC_DATA_DOUBLE, xdata, 0, size );
+  plotincColumnAssign( &ycolumn, PLOTINC_DATA_DOUBLE, ydata, 0, size );
+  plotincFramePlotDensityColumn2D( frame, cairo, &xcolumn, &ycolumn, colormap, scale );
+}
+
+/* add a streaming series with a ring buffer of a given capacity to a frame. */
+plotincSeries *plotincFrameAddSeries(plotincFrame *frame, int capacity)
+{
+  plotincSeries *series, *last;
+
+  if( capacity <= 0 || !( series = _plotincSeriesAlloc( capacity ) ) ) return NULL;
+  if( !frame->series_list )
+    frame->series_list = series;
+  else{
+    for( last=frame->series_list; last->next; last=last->next );
+    last->next = series;
+  }
+  return series;
+}
+
+/* let x-range of a frame follow the latest samples of series. */
+void plotincFrameEnableAutoScroll(plotincFrame *frame, double width)
+{
+  frame->scroll_width = width;
+  frame->flag_scroll = true;
+}
+
+void plotincFrameDisableAutoScroll(plotincFrame *frame)
+{
+  frame->flag_scroll = false;
+}
+
+/* scroll x-range of a frame if the latest sample went out of it.
+ * The range jumps by a margin so that scrolling happens only occasionally. */
+static bool _plotincFrameScroll(plotincFrame *frame)
+{
+  plotincSeries *series;
+  double x, xmax = -HUGE_VAL;
+
+  if( !frame->flag_scroll || frame->scroll_width <= 0 ) return false;
+  for( series=frame->series_list; series; series=series->next ){
+    if( series->num == 0 ) continue;
+    if( ( x = series->xbuf[_plotincSeriesIndex( series, series->num-1 )] ) > xmax ) xmax = x;
+  }
+  if( xmax <= frame->xaxis.range_max ) return false;
+  plotincFrameSetXRange( frame,
+    xmax - frame->scroll_width * ( 1 - PLOTINC_SCROLL_MARGIN ),
+    xmax + frame->scroll_width * PLOTINC_SCROLL_MARGIN );
+  return true;
+}
+
+/* stroke samples of a series after the from-th oldest one. */
+static void _plotincFrameStrokeSeries(const plotincFrame *frame, cairo_t *cairo, plotincSeries *series, int from)
+{
+  _plotincPath path;
+  int k, n;
+
+  if( from < 0 ) from = 0;
+  if( series->num - from >= 2 ){
+    cairo_set_source_rgb( cairo, series->r, series->g, series->b );
+    cairo_set_line_width( cairo, series->line_width );
+    _plotincPathInit( &path, frame, cairo, frame->decimation );
+    /* the ring buffer consists of at most two contiguous parts */
+    k = _plotincSeriesIndex( series, from );
+    n = series->num - from;
+    if( k + n > series->capacity ){
+      _plotincFramePathData( frame, &path, series->xbuf+k, series->ybuf+k, series->capacity - k, 0 );
+      n -= series->capacity - k;
+      k = 0;
+    }
+    _plotincFramePathData( frame, &path, series->xbuf+k, series->ybuf+k, n, 0 );
+    _plotincPathStroke( &path );
+  }
+  series->fresh = 0;
+  series->flag_evicted = false;
+}
+
+/* draw all samples of series on a frame. */
+void plotincFrameDrawSeries(const plotincFrame *frame, cairo_t *cairo)
+{
+  plotincSeries *series;
+
+  for( series=frame->series_list; series; series=series->next )
+    _plotincFrameStrokeSeries( frame, cairo, series, 0 );
+}
+
+/* whether series of a frame have samples not drawn yet or erased. */
+static bool _plotincFrameHasFresh(const plotincFrame *frame)
+{
+  plotincSeries *series;
+
+  for( series=frame->series_list; series; series=series->next )
+    if( series->fresh > 0 || series->flag_evicted ) return true;
+  return false;
+}
+
+/* draw only samples of series appended since the last draw on a frame.
+ * Nothing is drawn and false is returned if any samples drawn before are
+ * overwritten or cleared, which the frame has to be redrawn to erase. */
+bool plotincFrameUpdateSeries(const plotincFrame *frame, cairo_t *cairo)
+{
+  plotincSeries *series;
+
+  for( series=frame->series_list; series; series=series->next )
+    if( series->flag_evicted ) return false;
+  cairo_save( cairo );
+  cairo_rectangle( cairo, frame->plot_ox, frame->plot_oy, frame->plot_width, frame->plot_height );
+  cairo_clip( cairo );
+  for( series=frame->series_list; series; series=series->next )
+    if( series->fresh > 0 )
+      _plotincFrameStrokeSeries( frame, cairo, series, series->num - series->fresh - 1 );
+  cairo_restore( cairo );
+  return true;
+}
+
+/* curve evaluated by batches of parameters. The y-function of a graph of a
+ * function is evaluated at x-values instead of parameters. */
+typedef struct{
+  plotincBatchFunction xfunction;
+  void *xctx;
+  plotincBatchFunction yfunction;
+  void *yctx;
+  bool flag_graph;
+} _plotincCurve;
+
+static void _plotincCurveEval(const _plotincCurve *curve, const double t[], double x[], double y[], int n)
+{
+  curve->xfunction( curve->xctx, t, x, n );
+  curve->yfunction( curve->yctx, curve->flag_graph ? x : t, y, n );
+}
+
+/* function of a parameter with a context evaluated as a batch. */
+typedef struct{
+  double (* function)(void *, double);
+  void *ctx;
+} _plotincCtxFunction;
+
+static void _plotincCtxFunctionBatch(void *ctx, const double t[], double out[], size_t n)
+{
+  _plotincCtxFunction *f = ctx;
+  size_t i;
+
+  for( i=0; i<n; i++ ) out[i] = f->function( f->ctx, t[i] );
+}
+
+/* plain function of a parameter evaluated as a batch. */
+typedef struct{
+  double (* function)(double);
+} _plotincPlainFunction;
+
+static void _plotincPlainFunctionBatch(void *ctx, const double t[], double out[], size_t n)
+{
+  _plotincPlainFunction *f = ctx;
+  size_t i;
+
+  for( i=0; i<n; i++ ) out[i] = f->function( t[i] );
+}
+
+/* values on an axis at ratios of its range. */
+static void _plotincAxisValBatch(void *ctx, const double t[], double out[], size_t n)
+{
+  size_t i;
+
+  for( i=0; i<n; i++ ) out[i] = _plotincAxisVal( ctx, t[i] );
+}
+
+/* deviation of a point from a chord in device coordinates. */
+static double _plotincCurveDeviation(const plotincTransform *xt, const plotincTransform *yt, double x0, double y0, double xm, double ym, double x1, double y1)
+{
+  double dx, dy, mx, my, len;
+
+  x0 = _plotincTransformApply( xt, x0 ); y0 = _plotincTransformApply( yt, y0 );
+  xm = _plotincTransformApply( xt, xm ); ym = _plotincTransformApply( yt, ym );
+  x1 = _plotincTransformApply( xt, x1 ); y1 = _plotincTransformApply( yt, y1 );
+  dx = x1 - x0; dy = y1 - y0;
+  mx = xm - x0; my = ym - y0;
+  if( ( len = sqrt( dx*dx + dy*dy ) ) == 0 ) return sqrt( mx*mx + my*my );
+  return fabs( dx * my - dy * mx ) / len;
+}
+
+/* enable adaptive sampling of functions plotted on a frame.
+ * Intervals among uniform samples are bisected level by level while the
+ * deviation from the chord in pixels exceeds tolerance, up to max_num
+ * evaluations in total, which are spent on smaller parameters first at the
+ * level where they run out. */
+void plotincFrameEnableAdaptiveSampling(plotincFrame *frame, double tolerance, int max_num)
+{
+  frame->sampling_tolerance = tolerance;
+  frame->sampling_max = max_num;
+  frame->flag_adaptive = true;
+}
+
+void plotincFrameDisableAdaptiveSampling(plotincFrame *frame)
+{
+  frame->sampling_tolerance = 0;
+  frame->sampling_max = 0;
+  frame->flag_adaptive = false;
+}
+
+/* enable evaluation of samples of functions plotted on a frame on threads of
+ * the canvas. Functions, or batch functions with their contexts, have to be
+ * reentrant. */
+void plotincFrameEnableParallelSampling(plotincFrame *frame)
+{
+  frame->flag_parallel_sampling = true;
+}
+
+void plotincFrameDisableParallelSampling(plotincFrame *frame)
+{
+  frame->flag_parallel_sampling = false;
+}
+
+/* number of threads to evaluate samples of a curve on a frame. */
+static int _plotincFrameSamplingThreadNum(const plotincFrame *frame)
+{
+  return frame->flag_parallel_sampling ? _plotincFrameThreadNum( frame ) : 1;
+}
+
+/* evaluation of samples of a curve, split into jobs of contiguous samples. */
+typedef struct{
+  const _plotincCurve *curve;
+  const double *param;
+  double *xdata, *ydata;
+  int num;
+} _plotincSampling;
+
+static void _plotincSamplingJob(void *arg, int job)
+{
+  _plotincSampling *sampling = arg;
+  int from, to;
+
+  from = job * PLOTINC_SAMPLING_JOB_SIZE;
+  if( ( to = from + PLOTINC_SAMPLING_JOB_SIZE ) > sampling->num ) to = sampling->num;
+  _plotincCurveEval( sampling->curve, sampling->param+from, sampling->xdata+from, sampling->ydata+from, to - from );
+}
+
+/* evaluate a curve at num parameters, in parallel if enabled on a frame. */
+static void _plotincFrameSampleCurve(const plotincFrame *frame, const _plotincCurve *curve, const double param[], double xdata[], double ydata[], int num)
+{
+  _plotincSampling sampling;
+  int thread_num;
+
+  if( ( thread_num = _plotincFrameSamplingThreadNum( frame ) ) <= 1 ){
+    _plotincCurveEval( curve, param, xdata, ydata, num );
+    return;
+  }
+  sampling.curve = curve;
+  sampling.param = param;
+  sampling.xdata = xdata;
+  sampling.ydata = ydata;
+  sampling.num = num;
+  _plotincParallel( thread_num, ( num + PLOTINC_SAMPLING_JOB_SIZE - 1 ) / PLOTINC_SAMPLING_JOB_SIZE, _plotincSamplingJob, &sampling );
+}
+
+/* samples of a curve in order of parameters, each of which is followed by
+ * a gap to be bisected or not. */
+typedef struct{
+  double *param, *xdata, *ydata;
+  bool *flag_bisect;
+  int num;
+} _plotincCurveSamples;
+
+static bool _plotincCurveSamplesAlloc(_plotincCurveSamples *samples, int num)
+{
+  samples->param = malloc( sizeof(double)*num );
+  samples->xdata = malloc( sizeof(double)*num );
+  samples->ydata = malloc( sizeof(double)*num );
+  samples->flag_bisect = malloc( sizeof(bool)*num );
+  samples->num = num;
+  return samples->param && samples->xdata && samples->ydata && samples->flag_bisect;
+}
+
+static void _plotincCurveSamplesFree(_plotincCurveSamples *samples)
+{
+  free( samples->param );
+  free( samples->xdata );
+  free( samples->ydata );
+  free( samples->flag_bisect );
+}
+
+/* plot a curve on a frame with adaptive sampling, where sample_num uniform
+ * samples are refined level by level. Midpoints of all gaps to be bisected
+ * at a level are evaluated at once, in parallel if enabled, and if they
+ * exceed the evaluations left, only the gaps of the smallest parameters are
+ * bisected. Hence, samples do not depend on the number of threads. */
+static void _plotincFramePlotCurveAdaptive(const plotincFrame *frame, cairo_t *cairo, const _plotincCurve *curve, double param_min, double param_max, int sample_num)
+{
+  _plotincCurveSamples samples, refined, mid;
+  plotincTransform xt, yt;
+  double d;
+  int eval_left, depth, i, j, k;
+
+  memset( &refined, 0, sizeof(refined) );
+  memset( &mid, 0, sizeof(mid) );
+  if( !_plotincCurveSamplesAlloc( &samples, sample_num ) ) goto FAILURE;
+  for( i=0; i<sample_num; i++ ){
+    samples.param[i] = ( param_max - param_min ) * (double)i / ( sample_num - 1 ) + param_min;
+    samples.flag_bisect[i] = i < sample_num - 1;
+  }
+  _plotincFrameSampleCurve( frame, curve, samples.param, samples.xdata, samples.ydata, sample_num );
+  xt = plotincFrameXTransform( frame );
+  yt = plotincFrameYTransform( frame );
+  eval_left = frame->sampling_max - sample_num;
+  for( depth=0; depth<PLOTINC_ADAPTIVE_MAX_DEPTH && eval_left>0; depth++ ){
+    /* midpoints of gaps to be bisected */
+    for( k=0, i=0; i<samples.num-1; i++ )
+      if( samples.flag_bisect[i] && ( samples.flag_bisect[i] = k < eval_left ) ) k++;
+    if( k == 0 ) break;
+    if( !_plotincCurveSamplesAlloc( &mid, k ) ) goto FAILURE;
+    for( k=0, i=0; i<samples.num-1; i++ )
+      if( samples.flag_bisect[i] )
+        mid.param[k++] = ( samples.param[i] + samples.param[i+1] ) / 2;
+    _plotincFrameSampleCurve( frame, curve, mid.param, mid.xdata, mid.ydata, k );
+    eval_left -= k;
+    /* merge midpoints, around which gaps are bisected at the next level if
+     * they deviate from chords beyond the tolerance */
+    if( !_plotincCurveSamplesAlloc( &refined, samples.num + k ) ) goto FAILURE;
+    for( k=0, j=0, i=0; i<samples.num; i++ ){
+      refined.param[j] = samples.param[i];
+      refined.xdata[j] = samples.xdata[i];
+      refined.ydata[j] = samples.ydata[i];
+      refined.flag_bisect[j++] = false;
+      if( !samples.flag_bisect[i] ) continue;
+      d = _plotincCurveDeviation( &xt, &yt, samples.xdata[i], samples.ydata[i], mid.xdata[k], mid.ydata[k], samples.xdata[i+1], samples.ydata[i+1] );
+      refined.flag_bisect[j-1] = d > frame->sampling_tolerance;
+      refined.param[j] = mid.param[k];
+      refined.xdata[j] = mid.xdata[k];
+      refined.ydata[j] = mid.ydata[k++];
+      refined.flag_bisect[j++] = d > frame->sampling_tolerance;
+    }
+    _plotincCurveSamplesFree( &samples );
+    _plotincCurveSamplesFree( &mid );
+    samples = refined;
+    memset( &refined, 0, sizeof(refined) );
+    memset( &mid, 0, sizeof(mid) );
+  }
+  _plotincFramePlotData( frame, cairo, samples.xdata, samples.ydata, samples.num, frame->decimation );
+  goto TERMINATE;
+ FAILURE:
+  fprintf( stderr, "cannot allocate buffer for sampling.\n" );
+ TERMINATE:
+  _plotincCurveSamplesFree( &samples );
+  _plotincCurveSamplesFree( &refined );
+  _plotincCurveSamplesFree( &mid );
+}
+
+/* plot a curve on a frame through sample_num uniform samples evaluated at once. */
+static void _plotincFramePlotCurve(const plotincFrame *frame, cairo_t *cairo, const _plotincCurve *curve, double param_min, double param_max, int sample_num)
+{
+  double *param, *xdata, *ydata;
+  int i;
+
+  if( frame->flag_adaptive && sample_num >= 2 ){
+    _plotincFramePlotCurveAdaptive( frame, cairo, curve, param_min, param_max, sample_num );
+    return;
+  }
+  param = malloc( sizeof(double)*sample_num );
+  xdata = malloc( sizeof(double)*sample_num );
+  ydata = malloc( sizeof(double)*sample_num );
+  if( !param || !xdata || !ydata ){
+    fprintf( stderr, "cannot allocate buffer for sampling.\n" );
+    goto TERMINATE;
+  }
+  for( i=0; i<sample_num; i++ )
+    param[i] = ( param_max - param_min ) * (double)i / ( sample_num - 1 ) + param_min;
+  _plotincFrameSampleCurve( frame, curve, param, xdata, ydata, sample_num );
+  plotincFramePlotData2D( frame, cairo, xdata, ydata, sample_num );
+ TERMINATE:
+  free( param );
+  free( xdata );
+  free( ydata );
+}
+
+/* plot a parametric function on a frame, whose coordinates are evaluated by
+ * batch functions for arrays of parameters with a context. */
+void plotincFramePlotParametricFunctionBatch(const plotincFrame *frame, cairo_t *cairo, plotincBatchFunction xfunction, plotincBatchFunction yfunction, void *ctx, double param_min, double param_max, int sample_num)
+{
+  _plotincCurve curve;
+
+  curve.xfunction = xfunction;
+  curve.xctx = ctx;
+  curve.yfunction = yfunction;
+  curve.yctx = ctx;
+  curve.flag_graph = false;
+  _plotincFramePlotCurve( frame, cairo, &curve, param_min, param_max, sample_num );
+}
+
+/* plot a parametric function on a frame, whose coordinates are functions of
+ * a parameter with a context. */
+void plotincFramePlotParametricFunctionCtx(const plotincFrame *frame, cairo_t *cairo, double (* xfunction)(void *, double), double (* yfunction)(void *, double), void *ctx, double param_min, double param_max, int sample_num)
+{
+  _plotincCtxFunction xf, yf;
+  _plotincCurve curve;
+
+  xf.function = xfunction;
+  xf.ctx = ctx;
+  yf.function = yfunction;
+  yf.ctx = ctx;
+  curve.xfunction = curve.yfunction = _plotincCtxFunctionBatch;
+  curve.xctx = &xf;
+  curve.yctx = &yf;
+  curve.flag_graph = false;
+  _plotincFramePlotCurve( frame, cairo, &curve, param_min, param_max, sample_num );
+}
+
+/* plot a parametric function on a frame. */
+void plotincFramePlotParametricFunction(const plotincFrame *frame, cairo_t *cairo, double (* xfunction)(double), double (* yfunction)(double), double param_min, double param_max, int sample_num)
+{
+  _plotincPlainFunction xf, yf;
+  _plotincCurve curve;
+
+  xf.function = xfunction;
+  yf.function = yfunction;
+  curve.xfunction = curve.yfunction = _plotincPlainFunctionBatch;
+  curve.xctx = &xf;
+  curve.yctx = &yf;
+  curve.flag_graph = false;
+  _plotincFramePlotCurve( frame, cairo, &curve, param_min, param_max, sample_num );
+}
+
+/* plot a function on a frame, which is evaluated by a batch function for
+ * arrays of x-values with a context. */
+void plotincFramePlotFunctionBatch(const plotincFrame *frame, cairo_t *cairo, plotincBatchFunction function, void *ctx, int sample_num)
+{
+  _plotincCurve curve;
+
+  curve.xfunction = _plotincAxisValBatch;
+  curve.xctx = (void *)&frame->xaxis;
+  curve.yfunction = function;
+  curve.yctx = ctx;
+  curve.flag_graph = true;
+  _plotincFramePlotCurve( frame, cairo, &curve, 0, 1, sample_num );
+}
+
+/* plot a function of x-values with a context on a frame. */
+void plotincFramePlotFunctionCtx(const plotincFrame *frame, cairo_t *cairo, double (* function)(void *, double), void *ctx, int sample_num)
+{
+  _plotincCtxFunction f;
+
+  f.function = function;
+  f.ctx = ctx;
+  plotincFramePlotFunctionBatch( frame, cairo, _plotincCtxFunctionBatch, &f, sample_num );
+}
+
+/* plot a function on a frame. */
+void plotincFramePlotFunction(const plotincFrame *frame, cairo_t *cairo, double (* function)(double), int sample_num)
+{
+  _plotincPlainFunction f;
+
+  f.function = function;
+  plotincFramePlotFunctionBatch( frame, cairo, _plotincPlainFunctionBatch, &f, sample_num );
+}
+
+/* canvas */
+
+static void _plotincCanvasSetSize(plotincCanvas *canvas, int width, int height)
+{
+  canvas->width  = width;
+  canvas->height = height;
+}
+
+static void _plotincCanvasInitTexCache(plotincCanvas *canvas)
+{
+  canvas->texlabel_list = NULL;
+  canvas->texcache_dir[0] = '\0';
+  pthread_mutex_init( &canvas->texcache_mutex, NULL );
+}
+
+static void _plotincCanvasDestroyTexCache(plotincCanvas *canvas)
+{
+  plotincTexLabel *texlabel;
+
+  while( canvas->texlabel_list ){
+    texlabel = canvas->texlabel_list->next;
+    if( canvas->texlabel_list->image )
+      cairo_surface_destroy( canvas->texlabel_list->image );
+    free( canvas->texlabel_list );
+    canvas->texlabel_list = texlabel;
+  }
+  pthread_mutex_destroy( &canvas->texcache_mutex );
+}
+
+static bool _plotincCanvasInitFrame(plotincCanvas *canvas)
+{
+  canvas->row_size = 1;
+  canvas->col_size = 1;
+  canvas->frame_num = 0;
+  canvas->frame_capacity = 0;
+  canvas->frame_block_num = 0;
+  canvas->frame_list = canvas->frame_last = NULL;
+  if( !plotincCanvasAddRowFrame( canvas ) ) return false;
+  return true;
+}
+
+static void _plotincCanvasDestroyFrame(plotincCanvas *canvas)
+{
+  plotincFrame *frame_ptr;
+  int i;
+
+  for( frame_ptr=canvas->frame_list; frame_ptr; frame_ptr=frame_ptr->next )
+    plotincFrameDestroy( frame_ptr );
+  for( i=0; i<canvas->frame_block_num; i++ )
+    free( canvas->frame_block[i] );
+  canvas->frame_list = canvas->frame_last = NULL;
+  canvas->frame_num = canvas->frame_capacity = canvas->frame_block_num = 0;
+}
+
+static bool _plotincCanvasInit(plotincCanvas *canvas, int width, int height)
+{
+  _plotincCanvasSetSize( canvas, width, height );
+  canvas->thread_num = 1;
+  canvas->stats_file[0] = '\0';
+  canvas->animation = NULL;
+  canvas->resize_width = canvas->resize_height = 0;
+  canvas->flag_resize = canvas->flag_redraw = false;
+  pthread_mutex_init( &canvas->mutex, NULL );
+  _plotincCanvasInitTexCache( canvas );
+  if( _plotincCanvasInitFrame( canvas ) ) return true;
+  _plotincCanvasDestroyFrame( canvas );
+  _plotincCanvasDestroyTexCache( canvas );
+  pthread_mutex_destroy( &canvas->mutex );
+  return false;
+}
+
+/* the k-th frame of a canvas, which is in the b-th block of
+ * PLOTINC_FRAME_BLOCK_SIZE<<b frames from PLOTINC_FRAME_BLOCK_SIZE*((1<<b)-1). */
+static plotincFrame *_plotincCanvasFrameAt(const plotincCanvas *canvas, int k)
+{
+  int b, q;
+
+  for( b=0, q=k/PLOTINC_FRAME_BLOCK_SIZE+1; q>1; b++, q>>=1 );
+  return &canvas->frame_block[b][k-PLOTINC_FRAME_BLOCK_SIZE*((1<<b)-1)];
+}
+
+/* reserve blocks of frames of a canvas for num frames at least. */
+static bool _plotincCanvasReserveFrame(plotincCanvas *canvas, int num)
+{
+  int size;
+
+  while( canvas->frame_capacity < num ){
+    size = PLOTINC_FRAME_BLOCK_SIZE << canvas->frame_block_num;
+    if( canvas->frame_block_num == PLOTINC_FRAME_BLOCK_MAXNUM ||
+        !( canvas->frame_block[canvas->frame_block_num] = malloc( sizeof(plotincFrame)*size ) ) ){
+      fprintf( stderr, "cannot allocate memory for new frames.\n" );
+      return false;
     }
+    canvas->frame_block_num++;
+    canvas->frame_capacity += size;
   }
+  return true;
 }
 
-/* set grid line property of a frame. */
-static void _plotincFrameSetGridLine(cairo_t *cairo)
+/* append num frames to a canvas. */
+static bool _plotincCanvasAllocFrame(plotincCanvas *canvas, int num)
 {
-  double dash[] = { 6.0, 10.0 };
-  cairo_set_source_rgb( cairo, 0, 0, 0 ); /* black */
-  cairo_set_line_width( cairo, PLOTINC_GRID_LINEWIDTH );
-  cairo_set_dash( cairo, dash, sizeof(dash)/sizeof(double), 0 );
+  plotincFrame *frame;
+  int i;
+
+  if( !_plotincCanvasReserveFrame( canvas, canvas->frame_num + num ) ) return false;
+  for( i=0; i<num; i++ ){
+    frame = _plotincCanvasFrameAt( canvas, canvas->frame_num++ );
+    plotincFrameInit( frame );
+    frame->canvas = canvas;
+    if( !canvas->frame_list )
+      canvas->frame_list = frame;
+    else
+      canvas->frame_last->next = frame;
+    canvas->frame_last = frame;
+  }
+  return true;
 }
 
-/* draw x-grid of a frame. */
-void plotincFrameDrawXGrid(const plotincFrame *frame, cairo_t *cairo)
+/* place the k-th frame of a canvas on the grid in row-major order. */
+static void _plotincCanvasLayoutFrame(plotincCanvas *canvas, plotincFrame *frame, int k)
 {
-  double tics_width;
-  int i, tics;
+  double w, h;
 
-  _plotincFrameSetGridLine( cairo );
-  cairo_set_source_rgb( cairo, 0, 0, 0 ); /* black */
-  tics_width = _plotincAxisTicsWidth( &frame->xaxis );
-  if( frame->xaxis.range_max > 0 && frame->xaxis.range_min < 0 ){
-    for( i=1; ( tics = plotincFrameXCoord( frame,-i * tics_width ) ) > frame->plot_ox; i++ )
-      _plotincFrameDrawXTicsOne( frame, cairo, tics, 0, frame->plot_height );
-    for( i=1; ( tics = plotincFrameXCoord( frame, i * tics_width ) ) < frame->plot_ox + frame->plot_width; i++ )
-      _plotincFrameDrawXTicsOne( frame, cairo, tics, 0, frame->plot_height );
-  } else{
-    for( i=0; ; i++ ){
-      tics = plotincFrameXCoord( frame,  _plotincAxisTicsVal( &frame->xaxis, tics_width, i ) );
-      if( tics > frame->plot_ox && tics < frame->plot_ox + frame->plot_width )
-        _plotincFrameDrawXTicsOne( frame, cairo, tics, 0, frame->plot_height );
-      if( i > frame->xaxis.tics_num ) break;
-    }
-  }
-  cairo_set_dash( cairo, NULL, 0, 0 );
+  w = canvas->width  - PLOTINC_CANVAS_DEFAULT_PADDING * 2;
+  h = canvas->height - PLOTINC_CANVAS_DEFAULT_PADDING * 2;
+  plotincFrameResize( frame,
+    PLOTINC_CANVAS_DEFAULT_PADDING + w * (double)( k % canvas->col_size ) / canvas->col_size,
+    PLOTINC_CANVAS_DEFAULT_PADDING + h * (double)( k / canvas->col_size ) / canvas->row_size,
+    w / canvas->col_size, h / canvas->row_size );
 }
 
-/* draw y-grid of a frame. */
-void plotincFrameDrawYGrid(const plotincFrame *frame, cairo_t *cairo)
+static void _plotincCanvasResizeFrame(plotincCanvas *canvas)
 {
-  double tics_width;
-  int i, tics;
+  plotincFrame *frame_ptr;
+  int k;
 
-  _plotincFrameSetGridLine( cairo );
-  tics_width = _plotincAxisTicsWidth( &frame->yaxis );
-  if( frame->yaxis.range_max > 0 && frame->yaxis.range_min < 0 ){
-    for( i=1; ( tics = plotincFrameYCoord( frame,-i * tics_width ) ) < frame->plot_oy + frame->plot_height; i++ )
-      _plotincFrameDrawYTicsOne( frame, cairo, tics, 0, frame->plot_width );
-    for( i=1; ( tics = plotincFrameYCoord( frame, i * tics_width ) ) > frame->plot_oy; i++ )
-      _plotincFrameDrawYTicsOne( frame, cairo, tics, 0, frame->plot_width );
-  } else{
-    for( i=0; ; i++ ){
-      tics = plotincFrameYCoord( frame, _plotincAxisTicsVal( &frame->yaxis, tics_width, i ) );
-      if( tics > frame->plot_oy && tics < frame->plot_oy + frame->plot_height )
-        _plotincFrameDrawYTicsOne( frame, cairo, tics, 0, frame->plot_width );
-      if( i > frame->yaxis.tics_num ) break;
-    }
-  }
-  cairo_set_dash( cairo, NULL, 0, 0 );
+  for( k=0, frame_ptr=canvas->frame_list; frame_ptr && k<canvas->row_size*canvas->col_size; k++, frame_ptr=frame_ptr->next )
+    _plotincCanvasLayoutFrame( canvas, frame_ptr, k );
 }
 
-/* set grid line property of a frame. */
-static void _plotincFrameSetY2GridLine(cairo_t *cairo)
+/* place a frame added to a canvas, which relocates the others only if the grid grows. */
+static void _plotincCanvasLayoutAddedFrame(plotincCanvas *canvas, int row_size, int col_size)
 {
-  double dash[] = { 3.0, 5.0 };
-  cairo_set_source_rgb( cairo, 0, 0, 0 ); /* black */
-  cairo_set_line_width( cairo, PLOTINC_GRID_LINEWIDTH );
-  cairo_set_dash( cairo, dash, sizeof(dash)/sizeof(double), 0 );
+  if( canvas->row_size == row_size && canvas->col_size == col_size )
+    _plotincCanvasLayoutFrame( canvas, canvas->frame_last, canvas->frame_num-1 );
+  else
+    _plotincCanvasResizeFrame( canvas );
 }
 
-/* draw y2-grid of a frame. */
-void plotincFrameDrawY2Grid(const plotincFrame *frame, cairo_t *cairo)
+/* set number of threads to draw frames of a canvas in parallel.
+ * Drawing methods of frames have to be reentrant if num is more than one.
+ * They run in parallel only on image and animation canvases; other canvases
+ * are drawn serially. */
+void plotincCanvasSetThreadNum(plotincCanvas *canvas, int num)
 {
-  double tics_width;
-  int i, tics;
+  canvas->thread_num = num > 1 ? num : 1;
+}
 
-  _plotincFrameSetY2GridLine( cairo );
-  tics_width = _plotincAxisTicsWidth( &frame->y2axis );
-  if( frame->y2axis.range_max > 0 && frame->y2axis.range_min < 0 ){
-    for( i=1; ( tics = plotincFrameY2Coord( frame,-i * tics_width ) ) < frame->plot_oy + frame->plot_height; i++ )
-      _plotincFrameDrawYTicsOne( frame, cairo, tics, 0, frame->plot_width );
-    for( i=1; ( tics = plotincFrameY2Coord( frame, i * tics_width ) ) > frame->plot_oy; i++ )
-      _plotincFrameDrawYTicsOne( frame, cairo, tics, 0, frame->plot_width );
-  } else{
-    for( i=0; ; i++ ){
-      tics = plotincFrameY2Coord( frame, _plotincAxisTicsVal( &frame->y2axis, tics_width, i ) );
-      if( tics > frame->plot_oy && tics < frame->plot_oy + frame->plot_height )
-        _plotincFrameDrawYTicsOne( frame, cairo, tics, 0, frame->plot_width );
-      if( i > frame->y2axis.tics_num ) break;
-    }
+/* set a directory to cache images of labels rendered by TeX across runs.
+ * Cached images are named after a hash of their TeX sources. */
+void plotincCanvasSetTexCacheDir(plotincCanvas *canvas, const char *dir)
+{
+  if( dir && dir[0] ){
+    strncpy( canvas->texcache_dir, dir, PLOTINC_PATH_MAXSIZE-1 );
+    canvas->texcache_dir[PLOTINC_PATH_MAXSIZE-1] = '\0';
+  } else
+    canvas->texcache_dir[0] = '\0';
+}
+
+/* statistics of drawing all frames of a canvas. false is returned unless profiled. */
+bool plotincCanvasStats(const plotincCanvas *canvas, plotincStats *stats)
+{
+  plotincStats frame_stats;
+  plotincFrame *frame_ptr;
+  int i;
+
+  memset( stats, 0, sizeof(plotincStats) );
+  for( frame_ptr=canvas->frame_list; frame_ptr; frame_ptr=frame_ptr->next ){
+    if( !plotincFrameStats( frame_ptr, &frame_stats ) ) return false;
+    stats->draw_num += frame_stats.draw_num;
+    for( i=0; i<PLOTINC_PHASE_NUM; i++ )
+      stats->time[i] += frame_stats.time[i];
+    stats->emit_num += frame_stats.emit_num;
+    stats->cull_num += frame_stats.cull_num;
+    stats->decimate_num += frame_stats.decimate_num;
+    stats->simplify_num += frame_stats.simplify_num;
+    stats->tex_num += frame_stats.tex_num;
+    stats->texcache_hit_num += frame_stats.texcache_hit_num;
+    stats->background_hit_num += frame_stats.background_hit_num;
   }
-  cairo_set_dash( cairo, NULL, 0, 0 );
+  return canvas->frame_num > 0;
 }
 
-/* draw label of a frame. */
-static void _plotincFrameDrawLabel(const plotincFrame *frame, cairo_t *cairo, const char *label, int x, int y, double angle)
+/* reset statistics of drawing frames of a canvas. */
+void plotincCanvasResetStats(plotincCanvas *canvas)
 {
-  cairo_text_extents_t te;
+  plotincFrame *frame_ptr;
 
-  if( !label[0] ) return;
-  _plotincFrameRecallFont( frame, cairo );
-  cairo_text_extents( cairo, label, &te );
-  cairo_save( cairo );
-  cairo_translate( cairo, x, y );
-  cairo_rotate( cairo, angle );
-  cairo_translate( cairo, -te.width/2, 0 );
-  cairo_move_to( cairo, 0, 0 );
-  cairo_show_text( cairo, label );
-  cairo_restore( cairo );
+  for( frame_ptr=canvas->frame_list; frame_ptr; frame_ptr=frame_ptr->next )
+    if( frame_ptr->stats )
+      memset( frame_ptr->stats, 0, sizeof(plotincStats) );
 }
 
-/* draw label in TeX format of a file. */
-#define PATHSIZ 512
-static void _plotincFrameDrawTexLabel(const plotincFrame *frame, cairo_t *cairo, const char *label, int x, int y, double angle)
+/* set a file to which statistics of drawing are dumped when a canvas is closed.
+ * Nothing is dumped unless profiled. */
+void plotincCanvasSetStatsFile(plotincCanvas *canvas, const char *filename)
+{
+  if( filename && filename[0] ){
+    strncpy( canvas->stats_file, filename, PLOTINC_PATH_MAXSIZE-1 );
+    canvas->stats_file[PLOTINC_PATH_MAXSIZE-1] = '\0';
+  } else
+    canvas->stats_file[0] = '\0';
+}
+
+static void _plotincStatsFPrint(FILE *fp, const char *name, const plotincStats *stats)
+{
+  int i;
+
+  fprintf( fp, "%s,%ld", name, stats->draw_num );
+  for( i=0; i<PLOTINC_PHASE_NUM; i++ )
+    fprintf( fp, ",%.9f", stats->time[i] );
+  fprintf( fp, ",%ld,%ld,%ld,%ld,%ld,%ld,%ld\n", stats->emit_num, stats->cull_num,
+    stats->decimate_num, stats->simplify_num, stats->tex_num, stats->texcache_hit_num, stats->background_hit_num );
+}
+
+/* dump statistics of drawing frames of a canvas in CSV, a line per frame and the total. */
+static void _plotincCanvasDumpStats(plotincCanvas *canvas)
 {
+  plotincStats stats;
+  char name[BUFSIZ];
+  plotincFrame *frame_ptr;
   FILE *fp;
-  char tmpfile[PATHSIZ], outfile[PATHSIZ];
-  char cmd[BUFSIZ];
-  cairo_surface_t *label_image;
-  int label_width, label_height;
-  double scale;
+  int k;
 
-  if( !label[0] ) return;
-  strcpy( tmpfile, "_plotinc.XXXXXX" );
-  if( mkstemp( tmpfile ) < 0 ){
-    fprintf( stderr, "cannot create temprary file name." );
+  if( !canvas->stats_file[0] || !plotincCanvasStats( canvas, &stats ) ) return;
+  if( !( fp = fopen( canvas->stats_file, "w" ) ) ){
+    fprintf( stderr, "cannot open %s.\n", canvas->stats_file );
     return;
   }
-  sprintf( outfile, "%s.tex", tmpfile );
-  if( !( fp = fopen( outfile, "w" ) ) ){
-    fprintf( stderr, "cannot open a temprary file." );
-    return;
+  fprintf( fp, "frame,draws,time_frame,time_background,time_grid,time_tics,time_label,time_tex,time_border,time_draw,time_series,emitted,culled,decimated,simplified,tex,texcache_hits,background_hits\n" );
+  for( k=0, frame_ptr=canvas->frame_list; frame_ptr; k++, frame_ptr=frame_ptr->next ){
+    sprintf( name, "%d", k );
+    _plotincStatsFPrint( fp, name, frame_ptr->stats );
   }
-  fprintf( fp, "\\documentclass{jarticle}\n" );
-  fprintf( fp, "\\usepackage{amsmath,amssymb,bm}\n" );
-  fprintf( fp, "\\begin{document}\n" );
-  fprintf( fp, "%s\n", label );
-  fprintf( fp, "\\thispagestyle{empty}\n" );
-  fprintf( fp, "\\end{document}\n" );
-  fclose( fp ); /* temprary TeX file */
+  _plotincStatsFPrint( fp, "total", &stats );
+  fclose( fp );
+}
 
-  sprintf( cmd, "platex %s > /dev/null", outfile );
-  if( system( cmd ) == 0x7f ){
-    fprintf( stderr, "failed to make a DVI file." );
-    return;
-  }
-  sprintf( cmd, "dvips -E %s.dvi > /dev/null", tmpfile );
-  if( system( cmd ) == 0x7f ){
-    fprintf( stderr, "failed to make an EPS file." );
-    return;
-  }
-  sprintf( cmd, "pstopnm -portrait -pgm %s.ps > /dev/null", tmpfile );
-  if( system( cmd ) == 0x7f ){
-    fprintf( stderr, "failed to make a PGM file." );
+/* resize the back buffer of a canvas on X-Window system.
+ * The contents of the previous buffer are kept over white. */
+static void _plotincCanvasResizeBuffer(plotincCanvas *canvas, int width, int height)
+{
+  cairo_surface_t *surface;
+  cairo_t *cairo;
+
+  if( cairo_xlib_surface_get_width( canvas->surface ) == width &&
+      cairo_xlib_surface_get_height( canvas->surface ) == height ) return;
+  surface = cairo_surface_create_similar( canvas->window_surface, CAIRO_CONTENT_COLOR, width, height );
+  if( cairo_surface_status( surface ) != CAIRO_STATUS_SUCCESS ){
+    fprintf( stderr, "cannot resize the back buffer of a canvas.\n" );
+    cairo_surface_destroy( surface );
     return;
   }
-  sprintf( cmd, "convert %s001.pgm %s.png > /dev/null", tmpfile, tmpfile );
-  if( system( cmd ) == 0x7f ){
-    fprintf( stderr, "failed to make a PNG file." );
+  cairo = cairo_create( surface );
+  cairo_set_source_rgb( cairo, 1, 1, 1 ); /* white */
+  cairo_paint( cairo );
+  cairo_set_source_surface( cairo, canvas->surface, 0, 0 );
+  cairo_paint( cairo );
+  cairo_destroy( cairo );
+  cairo_destroy( canvas->cairo );
+  cairo_surface_destroy( canvas->surface );
+  canvas->surface = surface;
+  canvas->cairo = cairo_create( surface );
+  cairo_xlib_surface_set_size( canvas->window_surface, width, height );
+}
+
+/* present a region of the back buffer of a canvas on the window. */
+static void _plotincCanvasPresent(plotincCanvas *canvas, int x, int y, int width, int height)
+{
+  cairo_t *cairo;
+
+  if( !canvas->display ) return;
+  cairo_surface_flush( canvas->surface );
+  cairo = cairo_create( canvas->window_surface );
+  cairo_set_source_surface( cairo, canvas->surface, 0, 0 );
+  cairo_set_operator( cairo, CAIRO_OPERATOR_SOURCE );
+  cairo_rectangle( cairo, x, y, width, height );
+  cairo_fill( cairo );
+  cairo_destroy( cairo );
+  cairo_surface_flush( canvas->window_surface );
+  XFlush( canvas->display );
+}
+
+static void _plotincCanvasResize(plotincCanvas *canvas, int width, int height)
+{
+  if( canvas->display )
+    _plotincCanvasResizeBuffer( canvas, width, height );
+  _plotincCanvasSetSize( canvas, width, height );
+  _plotincCanvasResizeFrame( canvas );
+  canvas->flag_resize = false;
+}
+
+/* resize a canvas.
+ * A canvas on an animation is not resized, since all steps have the same size. */
+void plotincCanvasResize(plotincCanvas *canvas, int width, int height)
+{
+  if( canvas->animation ){
+    fprintf( stderr, "cannot resize a canvas on an animation.\n" );
     return;
   }
-  sprintf( outfile, "%s.png", tmpfile );
-  label_image = cairo_image_surface_create_from_png( outfile );
-  label_width = cairo_image_surface_get_width( label_image );
-  label_height = cairo_image_surface_get_height( label_image );
-  cairo_save( cairo );
-  scale = (double)frame->baseline_skip / label_height;
-  cairo_translate( cairo, x, y );
-  cairo_rotate( cairo, angle );
-  cairo_scale( cairo, scale, scale );
-  cairo_translate( cairo,-label_width/2, 0 );
-  cairo_set_source_surface( cairo, label_image, 0, 0 );
-  cairo_paint( cairo );
-  cairo_restore( cairo );
-  cairo_surface_destroy( label_image );
-  sprintf( cmd, "rm %s* > /dev/null", tmpfile );
-  if( system( cmd ) < 0 ){
-    fprintf( stderr, "cannot remove temporary files." );
+  pthread_mutex_lock( &canvas->mutex );
+  _plotincCanvasResize( canvas, width, height );
+  pthread_mutex_unlock( &canvas->mutex );
+}
+
+/* apply a resize of the window of a canvas recorded by the event thread. */
+static void _plotincCanvasApplyResize(plotincCanvas *canvas)
+{
+  if( canvas->flag_resize )
+    _plotincCanvasResize( canvas, canvas->resize_width, canvas->resize_height );
+}
+
+/* add a frame to a canvas, which grows the grid by drow rows and dcol
+ * columns if full. */
+static bool _plotincCanvasAddFrame(plotincCanvas *canvas, int drow, int dcol)
+{
+  int row_size, col_size;
+  bool ret = false;
+
+  pthread_mutex_lock( &canvas->mutex );
+  if( _plotincCanvasAllocFrame( canvas, 1 ) ){
+    row_size = canvas->row_size;
+    col_size = canvas->col_size;
+    if( canvas->row_size * canvas->col_size < canvas->frame_num ){
+      canvas->row_size += drow;
+      canvas->col_size += dcol;
+    }
+    _plotincCanvasLayoutAddedFrame( canvas, row_size, col_size );
+    ret = true;
   }
+  pthread_mutex_unlock( &canvas->mutex );
+  return ret;
 }
 
-/* draw x-label of a frame. */
-void plotincFrameDrawXLabel(const plotincFrame *frame, cairo_t *cairo)
+/* add a frame in row-direction to a canvas. */
+bool plotincCanvasAddRowFrame(plotincCanvas *canvas)
 {
-  if( strchr( frame->xaxis.label, '$' ) ){
-    _plotincFrameDrawTexLabel( frame, cairo, frame->xaxis.label,
-      frame->plot_ox + frame->plot_width/2,
-      frame->plot_oy + frame->plot_height + frame->baseline_skip + PLOTINC_BASELINE_MARGIN*2,
-      0 );
+  return _plotincCanvasAddFrame( canvas, 1, 0 );
+}
+
+/* add a frame in column-direction to a canvas. */
+bool plotincCanvasAddColFrame(plotincCanvas *canvas)
+{
+  return _plotincCanvasAddFrame( canvas, 0, 1 );
+}
+
+/* arrange frames of a canvas in a grid of row_size x col_size at once.
+ * Frames are added or removed from the last so that they fill the grid, and
+ * are laid out in a single pass. */
+bool plotincCanvasSetGrid(plotincCanvas *canvas, int row_size, int col_size)
+{
+  bool ret = true;
+
+  if( row_size <= 0 || col_size <= 0 ){
+    fprintf( stderr, "invalid grid size %dx%d.\n", row_size, col_size );
+    return false;
+  }
+  pthread_mutex_lock( &canvas->mutex );
+  if( canvas->frame_num < row_size * col_size ){
+    ret = _plotincCanvasAllocFrame( canvas, row_size * col_size - canvas->frame_num );
   } else{
-    _plotincFrameDrawLabel( frame, cairo, frame->xaxis.label,
-      frame->plot_ox + frame->plot_width/2,
-      frame->plot_oy + frame->plot_height + frame->baseline_skip*2,
-      0 );
+    while( canvas->frame_num > row_size * col_size )
+      plotincFrameDestroy( _plotincCanvasFrameAt( canvas, --canvas->frame_num ) );
+    canvas->frame_last = _plotincCanvasFrameAt( canvas, canvas->frame_num-1 );
+    canvas->frame_last->next = NULL;
+  }
+  if( ret ){
+    canvas->row_size = row_size;
+    canvas->col_size = col_size;
+    _plotincCanvasResizeFrame( canvas );
   }
+  pthread_mutex_unlock( &canvas->mutex );
+  return ret;
 }
 
-/* draw y-label of a frame. */
-void plotincFrameDrawYLabel(const plotincFrame *frame, cairo_t *cairo)
+/* a frame at a row and a column of a canvas, or the null pointer if none. */
+plotincFrame *plotincCanvasFrame(const plotincCanvas *canvas, int row, int col)
 {
-  if( strchr( frame->yaxis.label, '$' ) ){
-    _plotincFrameDrawTexLabel( frame, cairo, frame->yaxis.label,
-      frame->plot_ox - frame->baseline_skip*2 - PLOTINC_BASELINE_MARGIN,
-      frame->plot_oy + frame->plot_height/2,
-      -M_PI/2 );
-  } else{
-    _plotincFrameDrawLabel( frame, cairo, frame->yaxis.label,
-      frame->plot_ox - frame->baseline_skip - PLOTINC_BASELINE_MARGIN,
-      frame->plot_oy + frame->plot_height/2,
-     -M_PI/2 );
+  int k;
+
+  if( row < 0 || row >= canvas->row_size || col < 0 || col >= canvas->col_size ) return NULL;
+  return ( k = row * canvas->col_size + col ) < canvas->frame_num ? _plotincCanvasFrameAt( canvas, k ) : NULL;
+}
+
+static void _plotincCanvasClear(plotincCanvas *canvas)
+{
+  cairo_set_source_rgb( canvas->cairo, 1, 1, 1 ); /* white */
+  cairo_rectangle( canvas->cairo, 0, 0, canvas->width, canvas->height );
+  cairo_fill( canvas->cairo );
+}
+
+/* clear background of a canvas. */
+void plotincCanvasClear(plotincCanvas *canvas)
+{
+  pthread_mutex_lock( &canvas->mutex );
+  _plotincCanvasClear( canvas );
+  pthread_mutex_unlock( &canvas->mutex );
+}
+
+/* copy the state of a context which drawing methods of frames may inherit. */
+static void _plotincContextCopyState(cairo_t *dst, cairo_t *src)
+{
+  cairo_font_options_t *options;
+  cairo_matrix_t m;
+  double r, g, b, a;
+  double *dashes, offset;
+  int dash_num;
+
+  if( cairo_pattern_get_rgba( cairo_get_source( src ), &r, &g, &b, &a ) == CAIRO_STATUS_SUCCESS )
+    cairo_set_source_rgba( dst, r, g, b, a );
+  else
+    cairo_set_source( dst, cairo_get_source( src ) );
+  cairo_set_operator( dst, cairo_get_operator( src ) );
+  cairo_set_tolerance( dst, cairo_get_tolerance( src ) );
+  cairo_set_antialias( dst, cairo_get_antialias( src ) );
+  cairo_set_fill_rule( dst, cairo_get_fill_rule( src ) );
+  cairo_set_line_width( dst, cairo_get_line_width( src ) );
+  cairo_set_line_cap( dst, cairo_get_line_cap( src ) );
+  cairo_set_line_join( dst, cairo_get_line_join( src ) );
+  cairo_set_miter_limit( dst, cairo_get_miter_limit( src ) );
+  if( ( dash_num = cairo_get_dash_count( src ) ) > 0 &&
+      ( dashes = malloc( sizeof(double)*dash_num ) ) ){
+    cairo_get_dash( src, dashes, &offset );
+    cairo_set_dash( dst, dashes, dash_num, offset );
+    free( dashes );
   }
+  cairo_get_matrix( src, &m );
+  cairo_set_matrix( dst, &m );
+  options = cairo_font_options_create();
+  cairo_get_font_options( src, options );
+  cairo_set_font_options( dst, options );
+  cairo_font_options_destroy( options );
+  cairo_set_scaled_font( dst, cairo_get_scaled_font( src ) );
 }
 
-/* draw y2-label of a frame. */
-void plotincFrameDrawY2Label(const plotincFrame *frame, cairo_t *cairo)
+/* contents of frames of a canvas drawn on offscreen layers in parallel. */
+typedef struct{
+  plotincCanvas *canvas;
+  int *index;     /* frames whose contents are pending */
+  cairo_t **cairo; /* contexts on layers of the pending frames */
+  int num;
+} _plotincCanvasLayers;
+
+/* draw contents of a frame on its layer. */
+static void _plotincCanvasDrawLayer(void *arg, int i)
 {
-  if( strchr( frame->y2axis.label, '$' ) ){
-    _plotincFrameDrawTexLabel( frame, cairo, frame->y2axis.label,
-      frame->plot_ox + frame->plot_width + frame->baseline_skip + PLOTINC_BASELINE_MARGIN,
-      frame->plot_oy + frame->plot_height/2,
-      -M_PI/2 );
-  } else{
-    _plotincFrameDrawLabel( frame, cairo, frame->y2axis.label,
-      frame->plot_ox + frame->plot_width + frame->baseline_skip*2 + PLOTINC_BASELINE_MARGIN,
-      frame->plot_oy + frame->plot_height/2,
-     -M_PI/2 );
+  _plotincCanvasLayers *layers = arg;
+
+  _plotincFrameDrawContent( _plotincCanvasFrameAt( layers->canvas, layers->index[i] ), layers->cairo[i] );
+}
+
+/* draw contents of pending frames in parallel and copy them onto the canvas. */
+static void _plotincCanvasFlushLayers(_plotincCanvasLayers *layers)
+{
+  cairo_t *cairo = layers->canvas->cairo;
+  cairo_surface_t *layer;
+  plotincFrame *frame;
+  int i;
+
+  if( layers->num == 0 ) return;
+  _plotincParallel( layers->canvas->thread_num, layers->num, _plotincCanvasDrawLayer, layers );
+  for( i=0; i<layers->num; i++ ){
+    frame = _plotincCanvasFrameAt( layers->canvas, layers->index[i] );
+    layer = cairo_get_target( layers->cairo[i] );
+    cairo_surface_flush( layer );
+    cairo_save( cairo );
+    cairo_set_source_surface( cairo, layer, 0, 0 );
+    cairo_set_operator( cairo, CAIRO_OPERATOR_SOURCE );
+    cairo_rectangle( cairo, frame->plot_ox, frame->plot_oy, frame->plot_width, frame->plot_height );
+    cairo_fill( cairo );
+    cairo_restore( cairo );
+    cairo_destroy( layers->cairo[i] );
   }
+  layers->num = 0;
 }
 
-/* draw a frame. */
-void plotincFrameDraw(plotincFrame *frame, cairo_t *cairo)
+/* whether a frame drawn on a canvas may touch the plot region of a pending
+ * frame, namely its region padded by PLOTINC_CANVAS_LAYER_MARGIN, which
+ * antialiased edges and labels are supposed not to spill over, overlaps it. */
+static bool _plotincCanvasLayersOverlap(_plotincCanvasLayers *layers, const plotincFrame *frame)
 {
-  if( frame->xaxis.flag_grid  )  plotincFrameDrawXGrid(   frame, cairo );
-  if( frame->xaxis.flag_tics  )  plotincFrameDrawXTics(   frame, cairo );
-  if( frame->xaxis.flag_label )  plotincFrameDrawXLabel(  frame, cairo );
-  if( frame->yaxis.flag_grid  )  plotincFrameDrawYGrid(   frame, cairo );
-  if( frame->yaxis.flag_tics  )  plotincFrameDrawYTics(   frame, cairo );
-  if( frame->yaxis.flag_label )  plotincFrameDrawYLabel(  frame, cairo );
-  if( frame->y2axis.flag_grid  ) plotincFrameDrawY2Grid(  frame, cairo );
-  if( frame->y2axis.flag_tics  ) plotincFrameDrawY2Tics(  frame, cairo );
-  if( frame->y2axis.flag_label ) plotincFrameDrawY2Label( frame, cairo );
-  if( frame->flag_title )        plotincFrameDrawTitle(   frame, cairo );
-  plotincFrameDrawBorder( frame, cairo );
-  if( frame->draw ){
-    cairo_rectangle( cairo, frame->plot_ox, frame->plot_oy, frame->plot_width, frame->plot_height );
-    cairo_clip( cairo );
-    frame->draw( frame, cairo );
-    cairo_reset_clip( cairo );
+  const plotincFrame *pending;
+  int i;
+
+  for( i=0; i<layers->num; i++ ){
+    pending = _plotincCanvasFrameAt( layers->canvas, layers->index[i] );
+    if( frame->ox - PLOTINC_CANVAS_LAYER_MARGIN < pending->plot_ox + pending->plot_width &&
+        frame->ox + frame->width + PLOTINC_CANVAS_LAYER_MARGIN > pending->plot_ox &&
+        frame->oy - PLOTINC_CANVAS_LAYER_MARGIN < pending->plot_oy + pending->plot_height &&
+        frame->oy + frame->height + PLOTINC_CANVAS_LAYER_MARGIN > pending->plot_oy )
+      return true;
   }
+  return false;
 }
 
-/* draw a 2D point on a frame. */
-void plotincFrameDrawPoint(const plotincFrame *frame, cairo_t *cairo, double x, double y, double size)
+/* put off contents of a frame onto a layer covering its plot region, which
+ * starts with the pixels of the canvas and the state of the context there. */
+static bool _plotincCanvasPendLayer(_plotincCanvasLayers *layers, int k)
 {
-  int px, py;
+  plotincFrame *frame = _plotincCanvasFrameAt( layers->canvas, k );
+  cairo_surface_t *layer;
+  cairo_t *cairo;
 
-  if( ( px = plotincFrameXCoord( frame, x ) ) < 0 ) return;
-  if( ( py = plotincFrameYCoord( frame, y ) ) < 0 ) return;
-  cairo_move_to( cairo, px, py );
-  cairo_arc( cairo, px, py, size, 0, 360 );
-  cairo_fill( cairo );
+  if( frame->plot_width <= 0 || frame->plot_height <= 0 ) return false;
+  layer = cairo_image_surface_create( cairo_image_surface_get_format( layers->canvas->surface ), frame->plot_width, frame->plot_height );
+  cairo_surface_set_device_offset( layer, -frame->plot_ox, -frame->plot_oy );
+  cairo = cairo_create( layer );
+  cairo_surface_destroy( layer );
+  if( cairo_status( cairo ) != CAIRO_STATUS_SUCCESS ){
+    cairo_destroy( cairo );
+    return false;
+  }
+  cairo_surface_flush( layers->canvas->surface );
+  cairo_set_source_surface( cairo, layers->canvas->surface, 0, 0 );
+  cairo_set_operator( cairo, CAIRO_OPERATOR_SOURCE );
+  cairo_paint( cairo );
+  _plotincContextCopyState( cairo, layers->canvas->cairo );
+  layers->index[layers->num] = k;
+  layers->cairo[layers->num++] = cairo;
+  return true;
 }
 
-/* draw a 2D line segment on a frame. */
-void plotincFrameDrawLine(const plotincFrame *frame, cairo_t *cairo, double x0, double y0, double x1, double y1)
+/* draw frames of a canvas in order, while contents of frames are drawn in
+ * parallel. Bases of frames are drawn on the canvas, and contents clipped in
+ * plot regions are drawn on layers with the same pixels and state as the
+ * canvas in the regions, which are copied back before any later frame is
+ * drawn nearby. Hence, every pixel undergoes the same operations as drawn
+ * serially. It only works on image surfaces, on which layers are rasterized
+ * as the canvas is. */
+static bool _plotincCanvasDrawParallel(plotincCanvas *canvas)
 {
-  int px, py;
+  _plotincCanvasLayers layers;
+  plotincFrame *frame;
+  int k;
 
-  px = plotincFrameXCoord( frame, x0 );
-  py = plotincFrameYCoord( frame, y0 );
-  cairo_move_to( cairo, px, py );
-  px = plotincFrameXCoord( frame, x1 );
-  py = plotincFrameYCoord( frame, y1 );
-  cairo_line_to( cairo, px, py );
-  cairo_stroke( cairo );
+  if( cairo_surface_get_type( canvas->surface ) != CAIRO_SURFACE_TYPE_IMAGE ) return false;
+  layers.index = malloc( sizeof(int)*canvas->frame_num );
+  layers.cairo = malloc( sizeof(cairo_t *)*canvas->frame_num );
+  if( !layers.index || !layers.cairo ){
+    free( layers.index );
+    free( layers.cairo );
+    return false;
+  }
+  layers.canvas = canvas;
+  layers.num = 0;
+  for( k=0; k<canvas->frame_num; k++ ){
+    frame = _plotincCanvasFrameAt( canvas, k );
+    if( _plotincCanvasLayersOverlap( &layers, frame ) )
+      _plotincCanvasFlushLayers( &layers );
+    _plotincFrameDrawBase( frame, canvas->cairo );
+    if( _plotincFrameHasContent( frame ) && !_plotincCanvasPendLayer( &layers, k ) ){
+      _plotincCanvasFlushLayers( &layers );
+      _plotincFrameDrawContent( frame, canvas->cairo );
+    }
+  }
+  _plotincCanvasFlushLayers( &layers );
+  free( layers.index );
+  free( layers.cairo );
+  return true;
 }
 
-static void _plotincFrameFindMinMax(const double data[], int size, double *min, double *max)
+static void _plotincCanvasAnimationPush(plotincCanvas *canvas);
+static void _plotincCanvasAnimationSync(plotincCanvas *canvas);
+
+/* draw a canvas.
+ * A canvas on X-Window system is drawn on the back buffer, which is then
+ * presented on the window at once. A canvas on an animation is drawn as
+ * the next step, which is written on the background. */
+void plotincCanvasDraw(plotincCanvas *canvas)
 {
-  int i;
+  plotincFrame *frame_ptr;
 
-  *min = *max = data[0];
-  for( i=1; i<size; i++ ){
-    if( data[i] < *min ) *min = data[i];
-    if( data[i] > *max ) *max = data[i];
+  pthread_mutex_lock( &canvas->mutex );
+  _plotincCanvasApplyResize( canvas );
+  canvas->flag_redraw = false;
+  _plotincCanvasClear( canvas );
+  for( frame_ptr=canvas->frame_list; frame_ptr; frame_ptr=frame_ptr->next )
+    _plotincFrameScroll( frame_ptr );
+  if( canvas->thread_num <= 1 || canvas->frame_num <= 1 || !_plotincCanvasDrawParallel( canvas ) )
+    for( frame_ptr=canvas->frame_list; frame_ptr; frame_ptr=frame_ptr->next )
+      plotincFrameDraw( frame_ptr, canvas->cairo );
+  cairo_show_page( canvas->cairo );
+  _plotincCanvasPresent( canvas, 0, 0, canvas->width, canvas->height );
+  _plotincCanvasAnimationPush( canvas );
+  pthread_mutex_unlock( &canvas->mutex );
+}
+
+/* draw series appended since the last draw on a canvas.
+ * Frames are redrawn entirely only when their x-ranges scroll, samples of
+ * their series are overwritten or cleared, or the window is resized; other
+ * changes of frames require plotincCanvasDraw(). Only the regions drawn are
+ * presented on the window. Canvases on vector surfaces, which cannot be
+ * drawn over, are drawn entirely on a new page. */
+void plotincCanvasDrawUpdate(plotincCanvas *canvas)
+{
+  plotincFrame *frame_ptr;
+  int x0 = INT_MAX, y0 = INT_MAX, x1 = INT_MIN, y1 = INT_MIN;
+
+  pthread_mutex_lock( &canvas->mutex );
+  if( canvas->flag_resize || !_plotincSurfaceIsRaster( canvas->surface ) ){
+    pthread_mutex_unlock( &canvas->mutex );
+    plotincCanvasDraw( canvas );
+    return;
+  }
+  _plotincCanvasAnimationSync( canvas );
+  for( frame_ptr=canvas->frame_list; frame_ptr; frame_ptr=frame_ptr->next ){
+    if( !_plotincFrameScroll( frame_ptr ) ){
+      if( !_plotincFrameHasFresh( frame_ptr ) ) continue;
+      if( plotincFrameUpdateSeries( frame_ptr, canvas->cairo ) ){
+        if( frame_ptr->plot_ox < x0 ) x0 = frame_ptr->plot_ox;
+        if( frame_ptr->plot_oy < y0 ) y0 = frame_ptr->plot_oy;
+        if( frame_ptr->plot_ox + frame_ptr->plot_width  > x1 ) x1 = frame_ptr->plot_ox + frame_ptr->plot_width;
+        if( frame_ptr->plot_oy + frame_ptr->plot_height > y1 ) y1 = frame_ptr->plot_oy + frame_ptr->plot_height;
+        continue;
+      }
+    }
+    cairo_set_source_rgb( canvas->cairo, 1, 1, 1 ); /* white */
+    cairo_rectangle( canvas->cairo, frame_ptr->ox, frame_ptr->oy, frame_ptr->width, frame_ptr->height );
+    cairo_fill( canvas->cairo );
+    plotincFrameDraw( frame_ptr, canvas->cairo );
+    if( frame_ptr->ox < x0 ) x0 = frame_ptr->ox;
+    if( frame_ptr->oy < y0 ) y0 = frame_ptr->oy;
+    if( frame_ptr->ox + frame_ptr->width  > x1 ) x1 = frame_ptr->ox + frame_ptr->width;
+    if( frame_ptr->oy + frame_ptr->height > y1 ) y1 = frame_ptr->oy + frame_ptr->height;
   }
+  cairo_surface_flush( canvas->surface );
+  if( x0 < x1 && y0 < y1 )
+    _plotincCanvasPresent( canvas, x0, y0, x1 - x0, y1 - y0 );
+  _plotincCanvasAnimationPush( canvas );
+  pthread_mutex_unlock( &canvas->mutex );
 }
 
-/* set y-range of a frame based on 1-dimensional data. */
-void plotincFrameSetRangeByData1D(plotincFrame *frame, const double data[], int size)
+static void _plotincCanvasClose(plotincCanvas *canvas)
 {
-  double ymin, ymax;
+  _plotincCanvasDumpStats( canvas );
+  _plotincCanvasDestroyFrame( canvas );
+  _plotincCanvasDestroyTexCache( canvas );
 
-  plotincFrameSetXRange( frame, 0, size-1 );
-  _plotincFrameFindMinMax( data, size, &ymin, &ymax );
-  if( ymax > ymin )
-    plotincFrameSetYRange( frame, ymin, ymax );
+  cairo_destroy( canvas->cairo );
+  cairo_surface_destroy( canvas->surface );
+  pthread_mutex_destroy( &canvas->mutex );
 }
 
-/* plot 1-dimensional data on a frame. */
-void plotincFramePlotData1D(const plotincFrame *frame, cairo_t *cairo, const double data[], int size)
+/* request redraw of a canvas whose window is resized.
+ * The back buffer is grown with the contents kept over white and presented
+ * at once, while frames are laid out on the next draw by the application,
+ * so that neither frames nor drawing methods are touched from this thread. */
+static void _plotincCanvasResizeWindow(plotincCanvas *canvas, int width, int height)
 {
-  int i, px, py;
+  int buffer_width, buffer_height;
 
-  px = plotincFrameXCoord( frame, 0 );
-  py = plotincFrameYCoord( frame, data[0] );
-  cairo_move_to( cairo, px, py );
-  for( i=1; i<size; i++ ){
-    px = plotincFrameXCoord( frame, i );
-    py = plotincFrameYCoord( frame, data[i] );
-    cairo_line_to( cairo, px, py );
+  pthread_mutex_lock( &canvas->mutex );
+  canvas->resize_width = width;
+  canvas->resize_height = height;
+  if( ( canvas->flag_resize = width != canvas->width || height != canvas->height ) ){
+    buffer_width = cairo_xlib_surface_get_width( canvas->surface );
+    buffer_height = cairo_xlib_surface_get_height( canvas->surface );
+    if( width > buffer_width || height > buffer_height )
+      _plotincCanvasResizeBuffer( canvas, width > buffer_width ? width : buffer_width, height > buffer_height ? height : buffer_height );
+    _plotincCanvasPresent( canvas, 0, 0, width, height );
+    canvas->flag_redraw = true;
   }
-  cairo_stroke( cairo );
+  pthread_mutex_unlock( &canvas->mutex );
 }
 
-/* set x- and y-ranges of a frame based on 2-dimensional data. */
-void plotincFrameSetRangeByData2D(plotincFrame *frame, const double xdata[], const double ydata[], int size)
+/* whether a canvas is requested to be redrawn since the last draw, namely
+ * its window on X-Window system is resized. The application polls it and
+ * calls plotincCanvasDraw(), which lays out frames in the new size. */
+bool plotincCanvasNeedsRedraw(plotincCanvas *canvas)
 {
-  double xmin, xmax, ymin, ymax;
+  bool ret;
 
-  _plotincFrameFindMinMax( xdata, size, &xmin, &xmax );
-  if( xmax > xmin )
-    plotincFrameSetXRange( frame, xmin, xmax );
-  _plotincFrameFindMinMax( ydata, size, &ymin, &ymax );
-  if( ymax > ymin )
-    plotincFrameSetYRange( frame, ymin, ymax );
+  pthread_mutex_lock( &canvas->mutex );
+  ret = canvas->flag_redraw;
+  pthread_mutex_unlock( &canvas->mutex );
+  return ret;
 }
 
-/* plot 2-dimensional data on a frame. */
-void plotincFramePlotData2D(const plotincFrame *frame, cairo_t *cairo, const double xdata[], const double ydata[], int size)
+/* handle events of the window of a canvas on X-Window system.
+ * Exposed regions are restored from the back buffer, and a resized window
+ * requests redraw of the canvas. */
+static void *_plotincCanvasEventLoop(void *arg)
 {
-  int i, px, py;
+  plotincCanvas *canvas = arg;
+  XEvent *event = &canvas->event;
 
-  px = plotincFrameXCoord( frame, xdata[0] );
-  py = plotincFrameYCoord( frame, ydata[0] );
-  cairo_move_to( cairo, px, py );
-  for( i=1; i<size; i++ ){
-    px = plotincFrameXCoord( frame, xdata[i] );
-    py = plotincFrameYCoord( frame, ydata[i] );
-    cairo_line_to( cairo, px, py );
+  while( 1 ){
+    XNextEvent( canvas->event_display, event );
+    switch( event->type ){
+    case Expose:
+      pthread_mutex_lock( &canvas->mutex );
+      _plotincCanvasPresent( canvas, event->xexpose.x, event->xexpose.y, event->xexpose.width, event->xexpose.height );
+      pthread_mutex_unlock( &canvas->mutex );
+      break;
+    case ConfigureNotify:
+      /* only the last one of successive resizes matters */
+      while( XCheckTypedWindowEvent( canvas->event_display, canvas->win, ConfigureNotify, event ) );
+      _plotincCanvasResizeWindow( canvas, event->xconfigure.width, event->xconfigure.height );
+      break;
+    case ClientMessage: /* sent by plotincCanvasCloseX11() */
+      if( event->xclient.window == canvas->win ) return NULL;
+    default: ;
+    }
   }
-  cairo_stroke( cairo );
+  return NULL;
 }
 
-/* plot a parametric function on a frame. */
-void plotincFramePlotParametricFunction(const plotincFrame *frame, cairo_t *cairo, double (* xfunction)(double), double (* yfunction)(double), double param_min, double param_max, int sample_num)
+/* destroy the window of a canvas and disconnect from X server. */
+static void _plotincCanvasDestroyWindow(plotincCanvas *canvas)
 {
-  double *xdata, *ydata, param;
-  int i;
+  cairo_surface_destroy( canvas->window_surface );
+  XDestroyWindow( canvas->display, canvas->win );
+  XCloseDisplay( canvas->display );
+  XCloseDisplay( canvas->event_display );
+}
 
-  xdata = malloc( sizeof(double)*sample_num );
-  ydata = malloc( sizeof(double)*sample_num );
-  if( !xdata || !ydata ){
-    fprintf( stderr, "cannot allocate buffer for sampling." );
-    goto TERMINATE;
+/* open a canvas on X-Window system.
+ * The canvas is drawn on one connection to X server under the lock of the
+ * canvas, and events of the window are received on another connection by
+ * its own thread, so that XInitThreads() is not required.
+ * A resized window is presented at once with the previous drawing, and
+ * plotincCanvasNeedsRedraw() tells the application to redraw the canvas,
+ * which follows the new size on the next call of plotincCanvasDraw() or
+ * plotincCanvasDrawUpdate(). */
+bool plotincCanvasOpenX11(plotincCanvas *canvas, int width, int height)
+{
+  /* connect to X server */
+  if( !( canvas->display = XOpenDisplay( NULL ) ) ){
+    fprintf( stderr, "cannot connect to X server.\n" );
+    return false;
   }
-  for( i=0; i<sample_num; i++ ){
-    param = ( param_max - param_min ) * (double)i / ( sample_num - 1 ) + param_min;
-    xdata[i] = xfunction( param );
-    ydata[i] = yfunction( param );
+  if( !( canvas->event_display = XOpenDisplay( XDisplayString( canvas->display ) ) ) ){
+    fprintf( stderr, "cannot connect to X server.\n" );
+    XCloseDisplay( canvas->display );
+    return false;
   }
-  plotincFramePlotData2D( frame, cairo, xdata, ydata, sample_num );
- TERMINATE:
-  free( xdata );
-  free( ydata );
+  canvas->win = XCreateSimpleWindow( canvas->display, RootWindow( canvas->display, DefaultScreen(canvas->display) ),
+    0, 0, width, height, 0,
+    WhitePixel( canvas->display, DefaultScreen(canvas->display) ),
+    BlackPixel( canvas->display, DefaultScreen(canvas->display) ) );
+  XSync( canvas->display, False );
+  XSelectInput( canvas->event_display, canvas->win, ExposureMask | StructureNotifyMask );
+  XSync( canvas->event_display, False );
+  XMapWindow( canvas->display, canvas->win );
+  /* assign cairo surface of the window, back buffer and context */
+  canvas->window_surface = cairo_xlib_surface_create( canvas->display, canvas->win, DefaultVisual(canvas->display,0), width, height );
+  canvas->surface = cairo_surface_create_similar( canvas->window_surface, CAIRO_CONTENT_COLOR, width, height );
+  canvas->cairo = cairo_create( canvas->surface );
+  /* size and frames */
+  if( !_plotincCanvasInit( canvas, width, height ) ){
+    cairo_destroy( canvas->cairo );
+    cairo_surface_destroy( canvas->surface );
+    _plotincCanvasDestroyWindow( canvas );
+    return false;
+  }
+  _plotincCanvasClear( canvas );
+  if( pthread_create( &canvas->event_thread, NULL, _plotincCanvasEventLoop, canvas ) != 0 ){
+    fprintf( stderr, "cannot create a thread to handle events.\n" );
+    _plotincCanvasClose( canvas );
+    _plotincCanvasDestroyWindow( canvas );
+    return false;
+  }
+  return true;
 }
 
-/* plot a function on a frame. */
-void plotincFramePlotFunction(const plotincFrame *frame, cairo_t *cairo, double (* function)(double), int sample_num)
+/* close a canvas on X-Window system. */
+void plotincCanvasCloseX11(plotincCanvas *canvas)
 {
-  double xfunction(double param){ return _plotincAxisVal( &frame->xaxis, param ); }
-  double yfunction(double param){ return function( xfunction( param ) ); }
-  plotincFramePlotParametricFunction( frame, cairo, xfunction, yfunction, 0, 1, sample_num );
+  XEvent event;
+
+  /* wake up and terminate the event thread, which presents the canvas
+     through the same connection under the lock */
+  memset( &event, 0, sizeof(XEvent) );
+  event.xclient.type = ClientMessage;
+  event.xclient.window = canvas->win;
+  event.xclient.format = 32;
+  pthread_mutex_lock( &canvas->mutex );
+  XSendEvent( canvas->display, canvas->win, False, StructureNotifyMask, &event );
+  XFlush( canvas->display );
+  pthread_mutex_unlock( &canvas->mutex );
+  pthread_join( canvas->event_thread, NULL );
+
+  _plotincCanvasClose( canvas );
+  _plotincCanvasDestroyWindow( canvas );
 }
 
-/* canvas */
+/* open a canvas on a SVG file. */
+bool plotincCanvasOpenSVG(plotincCanvas *canvas, int width, int height, const char *filename)
+{
+  canvas->display = NULL;
+  /* assign cairo surface and context */
+  canvas->surface = cairo_svg_surface_create( filename, width, height );
+  canvas->cairo = cairo_create( canvas->surface );
+  /* size and frames */
+  return _plotincCanvasInit( canvas, width, height );
+}
 
-static void _plotincCanvasSetSize(plotincCanvas *canvas, int width, int height)
+/* close a canvas on a SVG file. */
+void plotincCanvasCloseSVG(plotincCanvas *canvas)
 {
-  canvas->width  = width;
-  canvas->height = height;
+  _plotincCanvasClose( canvas );
 }
 
-static bool _plotincCanvasInitFrame(plotincCanvas *canvas)
+/* open a canvas on an image in memory. */
+bool plotincCanvasOpenImage(plotincCanvas *canvas, int width, int height)
 {
-  canvas->row_size = 1;
-  canvas->col_size = 1;
-  canvas->frame_num = 0;
-  canvas->frame_list = canvas->frame_last = NULL;
-  if( !plotincCanvasAddRowFrame( canvas ) ) return false;
-  return true;
+  canvas->display = NULL;
+  /* assign cairo surface and context */
+  canvas->surface = cairo_image_surface_create( CAIRO_FORMAT_ARGB32, width, height );
+  if( cairo_surface_status( canvas->surface ) != CAIRO_STATUS_SUCCESS ){
+    fprintf( stderr, "cannot create an image surface.\n" );
+    cairo_surface_destroy( canvas->surface );
+    return false;
+  }
+  canvas->cairo = cairo_create( canvas->surface );
+  /* size and frames */
+  return _plotincCanvasInit( canvas, width, height );
 }
 
-static void _plotincCanvasDestroyFrame(plotincCanvas *canvas)
+/* close a canvas on an image in memory. */
+void plotincCanvasCloseImage(plotincCanvas *canvas)
 {
-  plotincFrame *frame_ptr;
+  _plotincCanvasClose( canvas );
+}
 
-  while( canvas->frame_list ){
-    frame_ptr = canvas->frame_list->next;
-    free( canvas->frame_list );
-    canvas->frame_list = frame_ptr;
-  }
+/* pixel buffer of a canvas on an image in ARGB32 format (native-endian 32-bit
+ * words with premultiplied alpha). The byte length of a row is stored in stride. */
+unsigned char *plotincCanvasImageData(plotincCanvas *canvas, int *stride)
+{
+  if( cairo_surface_get_type( canvas->surface ) != CAIRO_SURFACE_TYPE_IMAGE ) return NULL;
+  cairo_surface_flush( canvas->surface );
+  if( stride ) *stride = cairo_image_surface_get_stride( canvas->surface );
+  return cairo_image_surface_get_data( canvas->surface );
 }
 
-static bool _plotincCanvasAllocFrame(plotincCanvas *canvas)
+/* write a canvas on an image to a PNG file. */
+bool plotincCanvasWritePNG(plotincCanvas *canvas, const char *filename)
 {
-  plotincFrame *new_frame;
+  cairo_status_t status;
 
-  if( !( new_frame = malloc( sizeof(plotincFrame) ) ) ){
-    fprintf( stderr, "cannot allocate memory for a new canvas." );
+  if( ( status = cairo_surface_write_to_png( canvas->surface, filename ) ) != CAIRO_STATUS_SUCCESS ){
+    fprintf( stderr, "cannot write %s: %s\n", filename, cairo_status_to_string( status ) );
     return false;
   }
-  plotincFrameInit( new_frame );
-  if( !canvas->frame_list )
-    canvas->frame_list = canvas->frame_last = new_frame;
-  else{
-    canvas->frame_last->next = new_frame;
-    canvas->frame_last = new_frame;
+  return true;
+}
+
+/* animation */
+
+/* write whole bytes to a file descriptor. */
+static bool _plotincWriteAll(int fd, const void *buf, size_t size)
+{
+  const unsigned char *p = buf;
+  ssize_t n;
+
+  while( size > 0 ){
+    if( ( n = write( fd, p, size ) ) < 0 ){
+      if( errno == EINTR ) continue;
+      return false;
+    }
+    p += n;
+    size -= n;
   }
-  canvas->frame_num++;
   return true;
 }
 
-static void _plotincCanvasResizeFrame(plotincCanvas *canvas)
+/* components of a pixel in ARGB32 format with the alpha unpremultiplied. */
+static void _plotincPixelRGBA(uint32_t pixel, uint8_t rgba[4])
 {
-  int i, j, frame_width, frame_height;
-  double w, h;
-  plotincFrame *frame_ptr;
+  uint32_t a;
+
+  a = pixel >> 24;
+  rgba[0] = pixel >> 16;
+  rgba[1] = pixel >> 8;
+  rgba[2] = pixel;
+  rgba[3] = a;
+  if( a > 0 && a < 0xff ){
+    rgba[0] = ( rgba[0] * 0xff + a/2 ) / a;
+    rgba[1] = ( rgba[1] * 0xff + a/2 ) / a;
+    rgba[2] = ( rgba[2] * 0xff + a/2 ) / a;
+  }
+}
+
+/* convert pixels of a buffer to planes of 4:4:4 YCbCr in BT.601 studio range. */
+static void _plotincAnimationConvertY4M(const unsigned char *src, int stride, int width, int height, unsigned char *dst)
+{
+  unsigned char *y = dst, *cb = dst + width*height, *cr = dst + 2*width*height;
+  const uint32_t *row;
+  uint8_t rgba[4];
+  int i, j;
 
-  frame_width  = ( w = canvas->width  - PLOTINC_CANVAS_DEFAULT_PADDING * 2 ) / canvas->col_size;
-  frame_height = ( h = canvas->height - PLOTINC_CANVAS_DEFAULT_PADDING * 2 ) / canvas->row_size;
-  frame_ptr = canvas->frame_list;
-  for( i=0; i<canvas->row_size; i++ )
-    for( j=0; j<canvas->col_size; j++ ){
-      if( !frame_ptr ) return;
-      plotincFrameResize( frame_ptr,
-        PLOTINC_CANVAS_DEFAULT_PADDING + w * (double)j / canvas->col_size,
-        PLOTINC_CANVAS_DEFAULT_PADDING + h * (double)i / canvas->row_size,
-        frame_width, frame_height );
-      frame_ptr = frame_ptr->next;
+  for( i=0; i<height; i++ ){
+    row = (const uint32_t *)( src + stride*i );
+    for( j=0; j<width; j++ ){
+      _plotincPixelRGBA( row[j], rgba );
+      *y++  = ( (  66*rgba[0] + 129*rgba[1] +  25*rgba[2] + 128 ) >> 8 ) +  16;
+      *cb++ = ( ( -38*rgba[0] -  74*rgba[1] + 112*rgba[2] + 128 ) >> 8 ) + 128;
+      *cr++ = ( ( 112*rgba[0] -  94*rgba[1] -  18*rgba[2] + 128 ) >> 8 ) + 128;
     }
+  }
 }
 
-/* resize a canvas. */
-void plotincCanvasResize(plotincCanvas *canvas, int width, int height)
+/* convert pixels of a buffer to 8-bit RGBA in order of bytes. */
+static void _plotincAnimationConvertRGBA(const unsigned char *src, int stride, int width, int height, unsigned char *dst)
 {
-  _plotincCanvasSetSize( canvas, width, height );
-  _plotincCanvasResizeFrame( canvas );
+  const uint32_t *row;
+  int i, j;
+
+  for( i=0; i<height; i++ ){
+    row = (const uint32_t *)( src + stride*i );
+    for( j=0; j<width; j++, dst+=4 )
+      _plotincPixelRGBA( row[j], dst );
+  }
 }
 
-/* add a frame in row-direction to a canvas. */
-bool plotincCanvasAddRowFrame(plotincCanvas *canvas)
+/* write a step of an animation from a buffer. */
+static bool _plotincAnimationWrite(plotincAnimation *animation, cairo_surface_t *buffer)
 {
-  if( !_plotincCanvasAllocFrame( canvas ) ) return false;
-  if( canvas->row_size * canvas->col_size < canvas->frame_num )
-    canvas->row_size++;
-  _plotincCanvasResizeFrame( canvas );
+  char filename[PLOTINC_PATH_MAXSIZE], header[BUFSIZ];
+  cairo_status_t status;
+  int width, height;
+
+  if( animation->format == PLOTINC_ANIMATION_PNG ){
+    snprintf( filename, PLOTINC_PATH_MAXSIZE, animation->pattern, animation->step );
+    if( ( status = cairo_surface_write_to_png( buffer, filename ) ) != CAIRO_STATUS_SUCCESS ){
+      fprintf( stderr, "cannot write %s: %s\n", filename, cairo_status_to_string( status ) );
+      return false;
+    }
+    return true;
+  }
+  width = cairo_image_surface_get_width( buffer );
+  height = cairo_image_surface_get_height( buffer );
+  if( animation->format == PLOTINC_ANIMATION_Y4M ){
+    if( animation->step == 0 ){
+      sprintf( header, "YUV4MPEG2 W%d H%d F%d:1 Ip A1:1 C444\n", width, height, animation->rate );
+      if( !_plotincWriteAll( animation->fd, header, strlen(header) ) ) goto FAILURE;
+    }
+    _plotincAnimationConvertY4M( cairo_image_surface_get_data( buffer ), cairo_image_surface_get_stride( buffer ), width, height, animation->data );
+    if( !_plotincWriteAll( animation->fd, "FRAME\n", 6 ) ||
+        !_plotincWriteAll( animation->fd, animation->data, (size_t)width*height*3 ) ) goto FAILURE;
+  } else{
+    _plotincAnimationConvertRGBA( cairo_image_surface_get_data( buffer ), cairo_image_surface_get_stride( buffer ), width, height, animation->data );
+    if( !_plotincWriteAll( animation->fd, animation->data, (size_t)width*height*4 ) ) goto FAILURE;
+  }
   return true;
+
+ FAILURE:
+  fprintf( stderr, "cannot write a step of an animation: %s\n", strerror( errno ) );
+  return false;
 }
 
-/* add a frame in column-direction to a canvas. */
-bool plotincCanvasAddColFrame(plotincCanvas *canvas)
+/* write steps of an animation passed from a canvas one after another. */
+static void *_plotincAnimationWriter(void *arg)
 {
-  if( !_plotincCanvasAllocFrame( canvas ) ) return false;
-  if( canvas->row_size * canvas->col_size < canvas->frame_num )
-    canvas->col_size++;
-  _plotincCanvasResizeFrame( canvas );
-  return true;
+  plotincAnimation *animation = arg;
+  int pending;
+  bool flag_error = false;
+
+  pthread_mutex_lock( &animation->mutex );
+  while( 1 ){
+    while( animation->pending < 0 && !animation->flag_quit )
+      pthread_cond_wait( &animation->cond, &animation->mutex );
+    if( ( pending = animation->pending ) < 0 ) break;
+    pthread_mutex_unlock( &animation->mutex );
+    /* steps after a failure are dropped not to leave a stream broken in the middle */
+    if( !flag_error && !_plotincAnimationWrite( animation, animation->buffer[pending] ) )
+      flag_error = true;
+    pthread_mutex_lock( &animation->mutex );
+    animation->flag_error = flag_error;
+    animation->step++;
+    animation->pending = -1;
+    pthread_cond_broadcast( &animation->cond );
+  }
+  pthread_mutex_unlock( &animation->mutex );
+  return NULL;
 }
 
-/* clear background of a canvas. */
-void plotincCanvasClear(plotincCanvas *canvas)
+/* wait for the writer of an animation to finish the pending step. */
+static void _plotincAnimationWait(plotincAnimation *animation)
 {
-  cairo_set_source_rgb( canvas->cairo, 1, 1, 1 ); /* white */
-  cairo_rectangle( canvas->cairo, 0, 0, canvas->width, canvas->height );
-  cairo_fill( canvas->cairo );
+  pthread_mutex_lock( &animation->mutex );
+  while( animation->pending >= 0 )
+    pthread_cond_wait( &animation->cond, &animation->mutex );
+  pthread_mutex_unlock( &animation->mutex );
 }
 
-/* draw a canvas. */
-void plotincCanvasDraw(plotincCanvas *canvas)
+/* pass the drawn buffer of a canvas to the writer of the animation, and
+ * switch the canvas to the other buffer. */
+static void _plotincCanvasAnimationPush(plotincCanvas *canvas)
 {
-  plotincFrame *frame_ptr;
+  plotincAnimation *animation = canvas->animation;
 
-  plotincCanvasClear( canvas );
-  for( frame_ptr=canvas->frame_list; frame_ptr; frame_ptr=frame_ptr->next ){
-    plotincFrameDraw( frame_ptr, canvas->cairo );
+  if( !animation ) return;
+  cairo_surface_flush( canvas->surface );
+  _plotincAnimationWait( animation );
+  pthread_mutex_lock( &animation->mutex );
+  animation->pending = animation->current;
+  pthread_cond_broadcast( &animation->cond );
+  pthread_mutex_unlock( &animation->mutex );
+  animation->current ^= 1;
+  canvas->surface = animation->buffer[animation->current];
+  canvas->cairo = animation->cairo[animation->current];
+}
+
+/* copy the last step of an animation to the buffer to be drawn incrementally. */
+static void _plotincCanvasAnimationSync(plotincCanvas *canvas)
+{
+  plotincAnimation *animation = canvas->animation;
+
+  if( !animation ) return;
+  _plotincAnimationWait( animation );
+  cairo_save( canvas->cairo );
+  cairo_set_source_surface( canvas->cairo, animation->buffer[animation->current^1], 0, 0 );
+  cairo_set_operator( canvas->cairo, CAIRO_OPERATOR_SOURCE );
+  cairo_paint( canvas->cairo );
+  cairo_restore( canvas->cairo );
+}
+
+static void _plotincAnimationDestroy(plotincAnimation *animation)
+{
+  int i;
+
+  for( i=0; i<2; i++ ){
+    cairo_destroy( animation->cairo[i] );
+    cairo_surface_destroy( animation->buffer[i] );
   }
-  cairo_show_page( canvas->cairo );
+  free( animation->data );
+  free( animation );
 }
 
-static void _plotincCanvasClose(plotincCanvas *canvas)
+/* terminate the writer thread of an animation after the pending step is written. */
+static void _plotincAnimationStop(plotincAnimation *animation)
 {
-  _plotincCanvasDestroyFrame( canvas );
+  pthread_mutex_lock( &animation->mutex );
+  animation->flag_quit = true;
+  pthread_cond_broadcast( &animation->cond );
+  pthread_mutex_unlock( &animation->mutex );
+  pthread_join( animation->writer, NULL );
+  pthread_mutex_destroy( &animation->mutex );
+  pthread_cond_destroy( &animation->cond );
+}
 
-  cairo_destroy( canvas->cairo );
-  cairo_surface_destroy( canvas->surface );
+/* open a canvas on an animation, whose buffers and writer thread are
+ * reused throughout the steps. */
+static bool _plotincCanvasOpenAnimation(plotincCanvas *canvas, int width, int height, plotincAnimation *animation)
+{
+  int i;
+
+  canvas->display = NULL;
+  for( i=0; i<2; i++ ){
+    animation->buffer[i] = cairo_image_surface_create( CAIRO_FORMAT_ARGB32, width, height );
+    animation->cairo[i] = cairo_create( animation->buffer[i] );
+  }
+  if( cairo_surface_status( animation->buffer[0] ) != CAIRO_STATUS_SUCCESS ||
+      cairo_surface_status( animation->buffer[1] ) != CAIRO_STATUS_SUCCESS ){
+    fprintf( stderr, "cannot create image surfaces of an animation.\n" );
+    goto FAILURE;
+  }
+  if( animation->format != PLOTINC_ANIMATION_PNG &&
+      !( animation->data = malloc( (size_t)width*height*4 ) ) ){
+    fprintf( stderr, "cannot allocate memory for an animation.\n" );
+    goto FAILURE;
+  }
+  animation->rate = PLOTINC_ANIMATION_DEFAULT_RATE;
+  animation->current = 0;
+  animation->pending = -1;
+  animation->step = 0;
+  animation->flag_quit = animation->flag_error = false;
+  pthread_mutex_init( &animation->mutex, NULL );
+  pthread_cond_init( &animation->cond, NULL );
+  if( pthread_create( &animation->writer, NULL, _plotincAnimationWriter, animation ) != 0 ){
+    fprintf( stderr, "cannot create a thread to write an animation.\n" );
+    pthread_mutex_destroy( &animation->mutex );
+    pthread_cond_destroy( &animation->cond );
+    goto FAILURE;
+  }
+  canvas->surface = animation->buffer[0];
+  canvas->cairo = animation->cairo[0];
+  /* size and frames */
+  if( !_plotincCanvasInit( canvas, width, height ) ){
+    _plotincAnimationStop( animation );
+    goto FAILURE;
+  }
+  canvas->animation = animation;
+  return true;
+
+ FAILURE:
+  _plotincAnimationDestroy( animation );
+  return false;
 }
 
-/* open a canvas on X-Window system. */
-bool plotincCanvasOpenX11(plotincCanvas *canvas, int width, int height)
+/* open a canvas on an animation written to numbered PNG files, whose names
+ * are given by a printf-format pattern with the step number (e.g. "step%05d.png"). */
+bool plotincCanvasOpenAnimation(plotincCanvas *canvas, int width, int height, const char *pattern)
 {
-  /* connect to X server */
-  canvas->display = XOpenDisplay( NULL );
-  canvas->win = XCreateSimpleWindow( canvas->display, RootWindow( canvas->display, DefaultScreen(canvas->display) ),
-    0, 0, width, height, 0,
-    WhitePixel( canvas->display, DefaultScreen(canvas->display) ),
-    BlackPixel( canvas->display, DefaultScreen(canvas->display) ) );
-  XMapWindow( canvas->display, canvas->win );
-  XSelectInput( canvas->display, canvas->win, ExposureMask );
-  while( 1 ){
-    XNextEvent( canvas->display, &canvas->event );
-    if( canvas->event.type == Expose ) break;
+  plotincAnimation *animation;
+
+  if( !( animation = calloc( 1, sizeof(plotincAnimation) ) ) ){
+    fprintf( stderr, "cannot allocate memory for an animation.\n" );
+    return false;
   }
-  /* assign cairo surface and context */
-  canvas->surface = cairo_xlib_surface_create( canvas->display, canvas->win, DefaultVisual(canvas->display,0), width, height );
-  canvas->cairo = cairo_create( canvas->surface );
-  /* size */
-  _plotincCanvasSetSize( canvas, width, height );
-  return _plotincCanvasInitFrame( canvas );
+  animation->format = PLOTINC_ANIMATION_PNG;
+  strncpy( animation->pattern, pattern, PLOTINC_PATH_MAXSIZE-1 );
+  animation->fd = -1;
+  return _plotincCanvasOpenAnimation( canvas, width, height, animation );
 }
 
-/* close a canvas on X-Window system. */
-void plotincCanvasCloseX11(plotincCanvas *canvas)
+/* open a canvas on an animation written to a file descriptor (e.g. a pipe to
+ * an encoder) as a Y4M or raw RGBA stream. The descriptor is not closed. */
+bool plotincCanvasOpenAnimationStream(plotincCanvas *canvas, int width, int height, plotincAnimationFormat format, int fd)
 {
-  _plotincCanvasClose( canvas );
+  plotincAnimation *animation;
 
-  XDestroyWindow( canvas->display, canvas->win );
-  XCloseDisplay( canvas->display );
+  if( format != PLOTINC_ANIMATION_Y4M && format != PLOTINC_ANIMATION_RGBA ){
+    fprintf( stderr, "invalid format of an animation stream.\n" );
+    return false;
+  }
+  if( !( animation = calloc( 1, sizeof(plotincAnimation) ) ) ){
+    fprintf( stderr, "cannot allocate memory for an animation.\n" );
+    return false;
+  }
+  animation->format = format;
+  animation->fd = fd;
+  return _plotincCanvasOpenAnimation( canvas, width, height, animation );
 }
 
-/* open a canvas on a SVG file. */
-bool plotincCanvasOpenSVG(plotincCanvas *canvas, int width, int height, const char *filename)
+/* set frames per second of an animation, which is recorded in a Y4M stream
+ * and has to be set before the first draw. */
+void plotincCanvasSetAnimationRate(plotincCanvas *canvas, int rate)
 {
-  /* assign cairo surface and context */
-  canvas->surface = cairo_svg_surface_create( filename, width, height );
-  canvas->cairo = cairo_create( canvas->surface );
-  /* size */
-  _plotincCanvasSetSize( canvas, width, height );
-  return _plotincCanvasInitFrame( canvas );
+  if( canvas->animation && rate > 0 ) canvas->animation->rate = rate;
 }
 
-/* close a canvas on a SVG file. */
-void plotincCanvasCloseSVG(plotincCanvas *canvas)
+/* whether any step of an animation of a canvas failed to be written, e.g.
+ * on a broken pipe or a full disk. Steps after the failure are not written. */
+bool plotincCanvasAnimationError(plotincCanvas *canvas)
+{
+  plotincAnimation *animation = canvas->animation;
+  bool ret;
+
+  if( !animation ) return false;
+  pthread_mutex_lock( &animation->mutex );
+  ret = animation->flag_error;
+  pthread_mutex_unlock( &animation->mutex );
+  return ret;
+}
+
+/* close a canvas on an animation after the last step is written.
+ * false is returned if any step failed to be written. */
+bool plotincCanvasCloseAnimation(plotincCanvas *canvas)
 {
+  plotincAnimation *animation = canvas->animation;
+  bool ret;
+
+  _plotincAnimationStop( animation );
+  ret = !animation->flag_error;
+  /* buffers are destroyed with the animation */
+  canvas->cairo = NULL;
+  canvas->surface = NULL;
   _plotincCanvasClose( canvas );
+  _plotincAnimationDestroy( animation );
+  canvas->animation = NULL;
+  return ret;
 }